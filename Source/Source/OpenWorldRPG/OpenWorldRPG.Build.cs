@@ -9,7 +9,7 @@ public class OpenWorldRPG : ModuleRules
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
 		//added enhanced input
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput","HairStrandsCore", "GeometryCollectionEngine", "Niagara", "UMG", "AIModule", "NavigationSystem" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput","HairStrandsCore", "GeometryCollectionEngine", "Niagara", "UMG", "AIModule", "NavigationSystem", "DeveloperSettings" });
 
 		PrivateDependencyModuleNames.AddRange(new string[] { });
 
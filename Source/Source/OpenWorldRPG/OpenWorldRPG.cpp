@@ -4,3 +4,31 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, OpenWorldRPG, "OpenWorldRPG" );
+
+DEFINE_LOG_CATEGORY(LogOpenWorldRPG);
+
+/* =====================================================
+ * Profiling
+ * ===================================================== */
+
+UE_TRACE_CHANNEL_DEFINE(OpenWorldRPGChannel);
+
+DEFINE_STAT(STAT_RPG_AIUpdate);
+DEFINE_STAT(STAT_RPG_EnemyUpdate);
+DEFINE_STAT(STAT_RPG_FlowField);
+DEFINE_STAT(STAT_RPG_Engagement);
+DEFINE_STAT(STAT_RPG_WeaponSweep);
+DEFINE_STAT(STAT_RPG_CombatResolution);
+DEFINE_STAT(STAT_RPG_GetHit);
+DEFINE_STAT(STAT_RPG_ItemAnimation);
+DEFINE_STAT(STAT_RPG_Pickups);
+DEFINE_STAT(STAT_RPG_HUDUpdate);
+DEFINE_STAT(STAT_RPG_AnimUpdate);
+
+DEFINE_STAT(STAT_RPG_EnemiesTicked);
+DEFINE_STAT(STAT_RPG_TracesIssued);
+DEFINE_STAT(STAT_RPG_DamageEvents);
+
+TRACE_DECLARE_INT_COUNTER(RPG_EnemiesTicked, TEXT("OpenWorldRPG/EnemiesTicked"));
+TRACE_DECLARE_INT_COUNTER(RPG_TracesIssued, TEXT("OpenWorldRPG/TracesIssued"));
+TRACE_DECLARE_INT_COUNTER(RPG_DamageEvents, TEXT("OpenWorldRPG/DamageEvents"));
@@ -3,4 +3,54 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CountersTrace.h"
 
+OPENWORLDRPG_API DECLARE_LOG_CATEGORY_EXTERN(LogOpenWorldRPG, Log, All);
+
+/* =====================================================
+ * Profiling
+ * ===================================================== */
+
+// Gameplay scopes in Insights, capture with -trace=default,OpenWorldRPG
+UE_TRACE_CHANNEL_EXTERN(OpenWorldRPGChannel, OPENWORLDRPG_API);
+
+// Live view with "stat OpenWorldRPG"
+DECLARE_STATS_GROUP(TEXT("OpenWorldRPG"), STATGROUP_OpenWorldRPG, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AI Update"), STAT_RPG_AIUpdate, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy Update"), STAT_RPG_EnemyUpdate, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flow Field"), STAT_RPG_FlowField, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Engagement"), STAT_RPG_Engagement, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Weapon Sweep"), STAT_RPG_WeaponSweep, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Combat Resolution"), STAT_RPG_CombatResolution, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Hit"), STAT_RPG_GetHit, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Item Animation"), STAT_RPG_ItemAnimation, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pickups"), STAT_RPG_Pickups, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("HUD Update"), STAT_RPG_HUDUpdate, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Animation Update"), STAT_RPG_AnimUpdate, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+
+// Per-frame counts, reset by the stats system every frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Enemies Ticked"), STAT_RPG_EnemiesTicked, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces Issued"), STAT_RPG_TracesIssued, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Damage Events"), STAT_RPG_DamageEvents, STATGROUP_OpenWorldRPG, OPENWORLDRPG_API);
+
+// Running totals in the Insights counter track, so two captures can be compared directly
+TRACE_DECLARE_INT_COUNTER_EXTERN(RPG_EnemiesTicked);
+TRACE_DECLARE_INT_COUNTER_EXTERN(RPG_TracesIssued);
+TRACE_DECLARE_INT_COUNTER_EXTERN(RPG_DamageEvents);
+
+// Stat scope that also shows up on the OpenWorldRPG trace channel.
+// Opens two scoped objects, so it must stand on its own line inside a braced block
+#define RPG_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(STAT_RPG_##Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(RPG_##Stat, OpenWorldRPGChannel)
+
+// Bumps both the per-frame stat and the trace total, safe as the body of an unbraced if
+#define RPG_COUNTER_ADD(Counter, Amount) \
+	do \
+	{ \
+		INC_DWORD_STAT_BY(STAT_RPG_##Counter, Amount); \
+		TRACE_COUNTER_ADD(RPG_##Counter, Amount); \
+	} while (0)
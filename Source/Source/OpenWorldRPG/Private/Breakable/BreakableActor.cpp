@@ -5,6 +5,8 @@
 #include "GeometryCollection/GeometryCollectionComponent.h"
 #include "Items/Treasure.h"
 #include "Components/CapsuleComponent.h"
+#include "Spatial/SpatialHashSubsystem.h"
+#include "Items/LootAggregationSubsystem.h"
 // Sets default values
 ABreakableActor::ABreakableActor()
 {
@@ -32,7 +34,21 @@ ABreakableActor::ABreakableActor()
 void ABreakableActor::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->RegisterActor(this, ESpatialCategory::Breakable, false);
+	}
+}
+
+void ABreakableActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->UnregisterActor(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -47,17 +63,17 @@ void ABreakableActor::GetHit_Implementation(const FVector& ImpactPoint, AActor*
 	if (bBroken) return;   
 	bBroken = true;        
 
-	UWorld* World = GetWorld();
+	ULootAggregationSubsystem* Loot = GetWorld()->GetSubsystem<ULootAggregationSubsystem>();
 
-	//5 possible treasures
-	if (World && TreasureClasses.Num() > 0)
+	//5 possible treasures, merged into any treasure of the same kind already lying nearby
+	if (Loot && TreasureClasses.Num() > 0)
 	{
 		FVector Location = GetActorLocation();
 		Location.Z += 75.f;
 
 
 		const int32 Selection = FMath::RandRange(0, TreasureClasses.Num() - 1);
-		World->SpawnActor<ATreasure>(TreasureClasses[Selection], Location, GetActorRotation());
+		Loot->DropTreasure(TreasureClasses[Selection], FTransform(GetActorRotation(), Location));
 	}
 }
 
@@ -9,6 +9,11 @@
 #include "Components/CapsuleComponent.h"
 #include "Components/AttributeComponent.h"
 
+// =======================
+// Spatial
+// =======================
+#include "Spatial/SpatialHashSubsystem.h"
+
 // =======================
 // Items
 // =======================
@@ -20,6 +25,11 @@
 #include "Kismet/KismetSystemLibrary.h"
 #include "Kismet/GameplayStatics.h"
 
+// =======================
+// Profiling
+// =======================
+#include "OpenWorldRPG.h"
+
 /* =====================================================
  * Constructor
  * ===================================================== */
@@ -42,6 +52,27 @@ ABaseCharacter::ABaseCharacter()
 void ABaseCharacter::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Characters move, so the spatial hash refreshes their cell every frame
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->RegisterActor(this, GetSpatialCategory(), true);
+	}
+}
+
+void ABaseCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->UnregisterActor(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+ESpatialCategory ABaseCharacter::GetSpatialCategory() const
+{
+	return ESpatialCategory::Enemy;
 }
 
 void ABaseCharacter::Tick(float DeltaTime)
@@ -57,6 +88,8 @@ void ABaseCharacter::GetHit_Implementation(
 	const FVector& ImpactPoint,
 	AActor* Hitter)
 {
+	RPG_SCOPE_CYCLE_COUNTER(GetHit);
+
 	if (IsAlive() && Hitter)
 	{
 		DirectionalHitReact(Hitter->GetActorLocation());
@@ -137,7 +170,16 @@ void ABaseCharacter::SetWeaponCollisionEnabled(
 	if (EquippedWeapon && EquippedWeapon->GetWeaponBox())
 	{
 		EquippedWeapon->GetWeaponBox()->SetCollisionEnabled(CollisionEnabled);
-		EquippedWeapon->IgnoreActors.Empty();
+
+		// The attack notifies toggle collision, which is also the swing window
+		if (CollisionEnabled == ECollisionEnabled::NoCollision)
+		{
+			EquippedWeapon->EndSwing();
+		}
+		else
+		{
+			EquippedWeapon->BeginSwing();
+		}
 	}
 }
 
@@ -216,10 +258,15 @@ void ABaseCharacter::SpawnHitParticles(const FVector& ImpactPoint)
 {
 	if (HitParticles && GetWorld())
 	{
+		// Auto release returns the emitter to the world's particle pool when it finishes
 		UGameplayStatics::SpawnEmitterAtLocation(
 			GetWorld(),
 			HitParticles,
-			ImpactPoint);
+			ImpactPoint,
+			FRotator::ZeroRotator,
+			FVector(1.f),
+			true,
+			EPSCPoolMethod::AutoRelease);
 	}
 }
 
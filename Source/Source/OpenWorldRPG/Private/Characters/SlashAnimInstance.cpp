@@ -5,6 +5,7 @@
 #include "Characters/SlashCharacter.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "OpenWorldRPG.h"
 
 void USlashAnimInstance::NativeInitializeAnimation()
 {
@@ -23,6 +24,8 @@ void USlashAnimInstance::NativeUpdateAnimation(float Deltatime)
 {
 	Super::NativeUpdateAnimation(Deltatime);
 
+	RPG_SCOPE_CYCLE_COUNTER(AnimUpdate);
+
 	if (SlashCharacterMovement) 
 	{
 		GroundSpeed = UKismetMathLibrary::VSizeXY(SlashCharacterMovement->Velocity);
@@ -38,6 +38,7 @@
 #include "Items/Weapons/Weapon.h"
 #include "Items/Soul.h"
 #include "Items/Treasure.h"
+#include "Pooling/ActorPoolSubsystem.h"
 
 // =======================
 // Animation
@@ -50,6 +51,16 @@
 #include "HUD/SlashHUD.h"
 #include "HUD/SlashOverlay.h"
 
+// =======================
+// Spatial
+// =======================
+#include "Spatial/SpatialHashSubsystem.h"
+
+// =======================
+// Profiling
+// =======================
+#include "OpenWorldRPG.h"
+
 /* =====================================================
  * Constructor
  * ===================================================== */
@@ -117,9 +128,15 @@ void ASlashCharacter::BeginPlay()
 	}
 }
 
+ESpatialCategory ASlashCharacter::GetSpatialCategory() const
+{
+	return ESpatialCategory::Player;
+}
+
 void ASlashCharacter::Tick(float DeltaTime)
 {
-	if (Attributes && SlashOverlay)
+	//full stamina has nothing to regen and nothing new to show
+	if (Attributes && SlashOverlay && !Attributes->IsStaminaFull())
 	{
 		Attributes->RegenStamina(DeltaTime);
 		SlashOverlay->SetStaminaBarPercent(
@@ -218,11 +235,15 @@ float ASlashCharacter::TakeDamage(
 
 void ASlashCharacter::SetOverlappingItem(AItem* Item)
 {
+	RPG_SCOPE_CYCLE_COUNTER(Pickups);
+
 	OverlappingItem = Item;
 }
 
 void ASlashCharacter::AddSouls(ASoul* Soul)
 {
+	RPG_SCOPE_CYCLE_COUNTER(Pickups);
+
 	if (Attributes && SlashOverlay)
 	{
 		Attributes->AddSouls(Soul->GetSouls());
@@ -232,6 +253,8 @@ void ASlashCharacter::AddSouls(ASoul* Soul)
 
 void ASlashCharacter::AddGold(ATreasure* Treasure)
 {
+	RPG_SCOPE_CYCLE_COUNTER(Pickups);
+
 	if (Attributes && SlashOverlay)
 	{
 		Attributes->AddGold(Treasure->GetGold());
@@ -464,7 +487,7 @@ void ASlashCharacter::EKeyPressed()
 	{
 		if (EquippedWeapon)
 		{
-			EquippedWeapon->Destroy();
+			UActorPoolSubsystem::ReleaseOrDestroy(EquippedWeapon);
 		}
 		EquipWeapon(OverlappingWeapon);
 	}
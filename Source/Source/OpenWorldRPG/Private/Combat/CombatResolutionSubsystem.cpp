@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Combat/CombatResolutionSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+#include "Kismet/GameplayStatics.h"
+#include "OpenWorldRPG.h"
+
+// =======================
+// Interfaces
+// =======================
+#include "Interfaces/HitInterface.h"
+
+/* =====================================================
+ * Queue
+ * ===================================================== */
+
+void UCombatResolutionSubsystem::QueueHit(const FCombatHit& Hit)
+{
+	const AActor* Victim = Hit.Victim.Get();
+	if (Victim == nullptr) return;
+
+	// Unique IDs come from allocation, not from whichever weapon ticked first
+	const AController* InstigatorController = Hit.InstigatorController.Get();
+	const uint64 SortKey =
+		(static_cast<uint64>(Victim->GetUniqueID()) << 32) |
+		(InstigatorController ? InstigatorController->GetUniqueID() : 0u);
+
+	if (const int32* PendingIndex = KeyToPending.Find(SortKey))
+	{
+		FCombatHit& Merged = PendingHits[*PendingIndex];
+		Merged.Damage += Hit.Damage;
+		++Merged.NumMerged;
+		return;
+	}
+
+	FCombatHit& Pending = PendingHits.Add_GetRef(Hit);
+	Pending.SortKey = SortKey;
+	KeyToPending.Add(SortKey, PendingHits.Num() - 1);
+}
+
+void UCombatResolutionSubsystem::ResolveHit(const FCombatHit& Hit)
+{
+	ApplyHitDamage(Hit);
+	PlayHitReact(Hit);
+}
+
+void UCombatResolutionSubsystem::ApplyHitDamage(const FCombatHit& Hit)
+{
+	AActor* Victim = Hit.Victim.Get();
+	if (!IsValid(Victim)) return;
+
+	RPG_COUNTER_ADD(DamageEvents, 1);
+
+	UGameplayStatics::ApplyDamage(
+		Victim,
+		Hit.Damage,
+		Hit.InstigatorController.Get(),
+		Hit.DamageCauser.Get(),
+		UDamageType::StaticClass());
+}
+
+void UCombatResolutionSubsystem::PlayHitReact(const FCombatHit& Hit)
+{
+	AActor* Victim = Hit.Victim.Get();
+
+	// Damage may have destroyed or pooled the victim
+	if (!IsValid(Victim)) return;
+
+	if (Cast<IHitInterface>(Victim))
+	{
+		IHitInterface::Execute_GetHit(Victim, Hit.ImpactPoint, Hit.Hitter.Get());
+	}
+}
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UCombatResolutionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingHits.Num() == 0) return;
+
+	RPG_SCOPE_CYCLE_COUNTER(CombatResolution);
+
+	Swap(PendingHits, ResolvingHits);
+	KeyToPending.Reset();
+
+	// Same victim entries end up adjacent, ordered by instigator
+	ResolvingHits.Sort([](const FCombatHit& A, const FCombatHit& B) { return A.SortKey < B.SortKey; });
+
+	LastNumHits = 0;
+	LastNumVictims = 0;
+
+	for (int32 RunStart = 0; RunStart < ResolvingHits.Num();)
+	{
+		const uint64 VictimId = ResolvingHits[RunStart].SortKey >> 32;
+
+		int32 RunEnd = RunStart;
+		for (; RunEnd < ResolvingHits.Num() && (ResolvingHits[RunEnd].SortKey >> 32) == VictimId; ++RunEnd)
+		{
+			LastNumHits += ResolvingHits[RunEnd].NumMerged;
+			ApplyHitDamage(ResolvingHits[RunEnd]);
+		}
+
+		// One react per victim, after every instigator's damage, so a killing blow from any of them runs Die
+		PlayHitReact(ResolvingHits[RunEnd - 1]);
+
+		++LastNumVictims;
+		RunStart = RunEnd;
+	}
+
+	ResolvingHits.Reset();
+}
+
+TStatId UCombatResolutionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatResolutionSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatResolutionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
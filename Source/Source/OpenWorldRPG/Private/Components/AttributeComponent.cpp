@@ -66,3 +66,9 @@ void UAttributeComponent::RegenStamina(float DeltaTime)
 	Stamina = FMath::Clamp(Stamina + StaminaRegenRate * DeltaTime, 0.f, MaxStamina);
 }
 
+void UAttributeComponent::ResetAttributes()
+{
+	Health = MaxHealth;
+	Stamina = MaxStamina;
+}
+
@@ -14,10 +14,22 @@
 #include "AIController.h"
 #include "Navigation/PathFollowingComponent.h"
 #include "Perception/PawnSensingComponent.h"
+#include "Enemy/EnemyAISubsystem.h"
+#include "Enemy/EnemyPerceptionSubsystem.h"
+#include "Enemy/EnemyPathSubsystem.h"
+#include "Enemy/EnemyFlowFieldSubsystem.h"
+#include "Enemy/EnemyEngagementSubsystem.h"
+#include "Enemy/EnemyPoolSubsystem.h"
+#include "Enemy/EnemyStateStore.h"
+#include "Enemy/PatrolRoute.h"
+#include "Spatial/SpatialHashSubsystem.h"
+#include "Pooling/ActorPoolSubsystem.h"
+#include "OpenWorldRPG.h"
 
 // =======================
 // Components
 // =======================
+#include "Components/CapsuleComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/AttributeComponent.h"
 #include "HUD/HealthBarComponent.h"
@@ -27,6 +39,7 @@
 // =======================
 #include "Items/Weapons/Weapon.h"
 #include "Items/Soul.h"
+#include "Items/LootAggregationSubsystem.h"
 
 // =======================
 // Debug
@@ -43,7 +56,9 @@ class AWeapon;
 
 AEnemy::AEnemy()
 {
+	// AI normally runs from UEnemyAISubsystem, Tick is only a fallback
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	EnemyState = EEnemyState::EES_Patrolling;
 
@@ -77,12 +92,33 @@ void AEnemy::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	UpdateEnemy(DeltaTime);
+}
+
+/* =====================================================
+ * AI Update
+ * ===================================================== */
+
+void AEnemy::UpdateEnemy(float DeltaTime)
+{
 	if (IsDead()) return;
 
+	RPG_SCOPE_CYCLE_COUNTER(EnemyUpdate);
+	RPG_COUNTER_ADD(EnemiesTicked, 1);
+
 	// Decide between patrol logic and combat logic
 	if (EnemyState > EEnemyState::EES_Patrolling)
 	{
-		CheckCombatTarget();
+		// Under the AI subsystem range crossings are pushed through OnCombatRangeChanged,
+		// so this is only a periodic catch-all for things like lost line of sight
+		const bool bCombatCheckDue =
+			!bUseAISubsystem ||
+			GetWorld()->GetTimeSeconds() - LastCombatCheckTime >= CombatRecheckInterval;
+
+		if (bCombatCheckDue)
+		{
+			CheckCombatTarget();
+		}
 	}
 	else
 	{
@@ -96,6 +132,55 @@ void AEnemy::Tick(float DeltaTime)
 	}
 }
 
+void AEnemy::OnCombatRangeChanged(EEnemyRangeClass NewRangeClass)
+{
+	if (IsDead() || EnemyState <= EEnemyState::EES_Patrolling) return;
+
+	CheckCombatTarget();
+}
+
+void AEnemy::OnAITimerFired(EEnemyTimer Kind)
+{
+	switch (Kind)
+	{
+	case EEnemyTimer::Patrol:
+		PatrolTimerFinished();
+		break;
+
+	case EEnemyTimer::Attack:
+		Attack();
+		break;
+
+	case EEnemyTimer::Death:
+		DeathLifeSpanExpired();
+		break;
+	}
+}
+
+void AEnemy::SetAILOD(EEnemyAILOD NewLOD)
+{
+	if (NewLOD == AILOD) return;
+
+	const EEnemyAILOD OldLOD = AILOD;
+	AILOD = NewLOD;
+
+	if (OldLOD == EEnemyAILOD::EAL_Dormant)
+	{
+		ExitDormantLOD();
+	}
+
+	if (NewLOD == EEnemyAILOD::EAL_Dormant)
+	{
+		EnterDormantLOD();
+	}
+	else if (PawnSensing)
+	{
+		// Reduced LOD senses less often, full LOD uses the authored interval
+		const float IntervalScale = NewLOD == EEnemyAILOD::EAL_Reduced ? 4.f : 1.f;
+		PawnSensing->SensingInterval = DefaultSensingInterval * IntervalScale;
+	}
+}
+
 float AEnemy::TakeDamage(
 	float DamageAmount,
 	FDamageEvent const& DamageEvent,
@@ -106,10 +191,17 @@ float AEnemy::TakeDamage(
 
 	// Set combat target to the instigator
 	CombatTarget = EventInstigator->GetPawn();
+	LastCombatTargetSeenTime = GetWorld()->GetTimeSeconds();
+
+	// Waiters keep circling, being hit doesn't jump the token queue
+	if (IsWaitingForAttackToken())
+	{
+		return DamageAmount;
+	}
 
 	if (IsInsideAttackRadius())
 	{
-		EnemyState = EEnemyState::EES_Attacking;
+		SetEnemyState(EEnemyState::EES_Attacking);
 	}
 	else if (IsOutsideAttackRadius())
 	{
@@ -124,7 +216,8 @@ void AEnemy::Destroyed()
 	// Clean up equipped weapon
 	if (EquippedWeapon)
 	{
-		EquippedWeapon->Destroy();
+		UActorPoolSubsystem::ReleaseOrDestroy(EquippedWeapon);
+		EquippedWeapon = nullptr;
 	}
 }
 
@@ -149,7 +242,7 @@ void AEnemy::GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter)
 
 	if (IsInsideAttackRadius())
 	{
-		if (!IsDead())
+		if (!IsDead() && RequestAttackToken())
 		{
 			StartAttackTimer();
 		}
@@ -164,14 +257,24 @@ void AEnemy::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Bind pawn sensing callback
+	// Sight checks run through the perception subsystem, so the component never polls itself
 	if (PawnSensing)
 	{
-		PawnSensing->OnSeePawn.AddDynamic(this, &AEnemy::PawnSeen);
+		PawnSensing->SetSensingUpdatesEnabled(false);
+		DefaultSensingInterval = PawnSensing->SensingInterval;
 	}
 
 	InitializeEnemy();
 	Tags.Add(FName("Enemy"));
+
+	RegisterWithAIServices();
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterFromAIServices();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 /* =====================================================
@@ -182,17 +285,20 @@ void AEnemy::Die_Implementation()
 {
 	Super::Die_Implementation();
 
-	EnemyState = EEnemyState::EES_Dead;
+	SetEnemyState(EEnemyState::EES_Dead);
 
+	CancelPathRequests();
 	ClearPatrolTimer();
 	ClearAttackTimer();
+	ReleaseAttackToken();
 	HideHealthBar();
 
 	DisableCapsule();
 	GetCharacterMovement()->bOrientRotationToMovement = false;
 	SetWeaponCollisionEnabled(ECollisionEnabled::NoCollision);
 
-	SetLifeSpan(DeathLifeSpan);
+	ArmAITimer(DeathTimer, EEnemyTimer::Death, DeathLifeSpan);
+
 	SpawnSoul();
 }
 
@@ -202,16 +308,18 @@ void AEnemy::Attack()
 
 	if (CombatTarget == nullptr) return;
 
-	EnemyState = EEnemyState::EES_Engaged;
+	SetEnemyState(EEnemyState::EES_Engaged);
 	PlayAttackMontage();
 }
 
 bool AEnemy::CanAttack()
 {
+	// No side effects, CheckCombatTarget asks for the attack token once this passes
 	const bool bCanAttack =
 		IsInsideAttackRadius() &&
 		!IsAttacking() &&
 		!IsEngaged() &&
+		!IsWaitingForAttackToken() &&
 		!IsDead();
 
 	return bCanAttack;
@@ -219,7 +327,10 @@ bool AEnemy::CanAttack()
 
 void AEnemy::AttackEnd()
 {
-	EnemyState = EEnemyState::EES_NoState;
+	SetEnemyState(EEnemyState::EES_NoState);
+
+	// Hand the token to whoever has waited longest before asking again
+	ReleaseAttackToken();
 	CheckCombatTarget();
 }
 
@@ -241,12 +352,14 @@ void AEnemy::InitializeEnemy()
 {
 	EnemyController = Cast<AAIController>(GetController());
 
-	if (PatrolTargets.Num() > 0)
+	// Keep a target assigned before BeginPlay, e.g. by the crowd handing over its route
+	if (PatrolTarget == nullptr)
 	{
-		PatrolTarget = PatrolTargets[0];
-		MoveToTarget(PatrolTarget);
+		PatrolTarget = ChooseFirstPatrolTarget();
 	}
 
+	MoveToTarget(PatrolTarget);
+
 	HideHealthBar();
 	SpawnDefaultWeapon();
 }
@@ -258,17 +371,16 @@ void AEnemy::CheckPatrolTarget()
 		PatrolTarget = ChoosePatrolTarget();
 
 		const float WaitTime = FMath::RandRange(PatrolWaitMin, PatrolWaitMax);
-		GetWorldTimerManager().SetTimer(
-			PatrolTimer,
-			this,
-			&AEnemy::PatrolTimerFinished,
-			WaitTime);
+		ArmAITimer(PatrolTimer, EEnemyTimer::Patrol, WaitTime);
 	}
 }
 
 void AEnemy::CheckCombatTarget()
 {
-	if (IsOutsideCombatRadius())
+	LastCombatCheckTime = GetWorld()->GetTimeSeconds();
+	RefreshCombatTargetSight();
+
+	if (IsOutsideCombatRadius() || HasLostSightOfCombatTarget())
 	{
 		ClearAttackTimer();
 		LoseInterest();
@@ -280,14 +392,22 @@ void AEnemy::CheckCombatTarget()
 	}
 	else if (IsOutsideAttackRadius() && !IsChasing())
 	{
+		// Waiters drift around their ring, only a target that got away sends them chasing
+		if (bWaitingForAttackToken &&
+			InTargetRange(CombatTarget, UEnemyEngagementSubsystem::GetWaitRadius(AttackRadius)))
+		{
+			return;
+		}
+
 		ClearAttackTimer();
 
 		if (!IsEngaged())
 		{
+			ReleaseAttackToken();
 			ChaseTarget();
 		}
 	}
-	else if (CanAttack())
+	else if (CanAttack() && RequestAttackToken())
 	{
 		StartAttackTimer();
 	}
@@ -316,21 +436,56 @@ void AEnemy::ShowHealthBar()
 
 void AEnemy::LoseInterest()
 {
+	ReleaseAttackToken();
 	CombatTarget = nullptr;
 	HideHealthBar();
 }
 
+void AEnemy::SetEnemyState(EEnemyState NewState)
+{
+	const bool bWasInCombat = EnemyState > EEnemyState::EES_Patrolling;
+	EnemyState = NewState;
+
+	const bool bInCombat = EnemyState > EEnemyState::EES_Patrolling;
+	if (bInCombat == bWasInCombat) return;
+
+	if (UEnemyAISubsystem* AISubsystem = GetWorld()->GetSubsystem<UEnemyAISubsystem>())
+	{
+		AISubsystem->SetEnemyInCombat(this, bInCombat);
+	}
+}
+
 void AEnemy::StartPatrolling()
 {
-	EnemyState = EEnemyState::EES_Patrolling;
+	SetEnemyState(EEnemyState::EES_Patrolling);
 	GetCharacterMovement()->MaxWalkSpeed = PatrollingSpeed;
 	MoveToTarget(PatrolTarget);
+
+	// Back on patrol, anyone still in view should be reported again
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->ResetObserver(this);
+	}
 }
 
 void AEnemy::ChaseTarget()
 {
-	EnemyState = EEnemyState::EES_Chasing;
+	SetEnemyState(EEnemyState::EES_Chasing);
 	GetCharacterMovement()->MaxWalkSpeed = ChasingSpeed;
+
+	// Chasing the player inside the flow field needs no path of its own
+	UEnemyFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UEnemyFlowFieldSubsystem>();
+	if (FlowField && FlowField->CanGuide(CombatTarget, GetActorLocation()))
+	{
+		CancelPathRequests();
+		if (EnemyController)
+		{
+			EnemyController->StopMovement();
+		}
+		FlowField->AddFollower(this);
+		return;
+	}
+
 	MoveToTarget(CombatTarget);
 }
 
@@ -369,57 +524,186 @@ bool AEnemy::IsEngaged()
 	return EnemyState == EEnemyState::EES_Engaged;
 }
 
+void AEnemy::EnterDormantLOD()
+{
+	// Freeze movement, animation and any in-flight patrol move
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	GetMesh()->SetComponentTickEnabled(false);
+
+	// The wheel has no pause, so hold on to what's left of the wait instead
+	if (UEnemyAISubsystem* AISubsystem = GetWorld()->GetSubsystem<UEnemyAISubsystem>())
+	{
+		PausedPatrolWait = AISubsystem->GetTimerRemaining(PatrolTimer);
+	}
+	CancelAITimer(PatrolTimer);
+
+	if (EnemyController && EnemyController->GetPathFollowingComponent())
+	{
+		EnemyController->GetPathFollowingComponent()->PauseMove();
+	}
+}
+
+void AEnemy::ExitDormantLOD()
+{
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	GetMesh()->SetComponentTickEnabled(true);
+
+	if (PausedPatrolWait > 0.f)
+	{
+		ArmAITimer(PatrolTimer, EEnemyTimer::Patrol, PausedPatrolWait);
+		PausedPatrolWait = 0.f;
+	}
+
+	if (EnemyController && EnemyController->GetPathFollowingComponent())
+	{
+		EnemyController->GetPathFollowingComponent()->ResumeMove();
+	}
+}
+
+void AEnemy::RegisterWithAIServices()
+{
+	UEnemyAISubsystem* AISubsystem = GetWorld()->GetSubsystem<UEnemyAISubsystem>();
+	if (bUseAISubsystem && AISubsystem)
+	{
+		AISubsystem->RegisterEnemy(this);
+	}
+	else
+	{
+		SetActorTickEnabled(true);
+	}
+
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->RegisterObserver(this);
+	}
+}
+
+void AEnemy::UnregisterFromAIServices()
+{
+	if (UEnemyAISubsystem* AISubsystem = GetWorld()->GetSubsystem<UEnemyAISubsystem>())
+	{
+		AISubsystem->UnregisterEnemy(this);
+	}
+
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->UnregisterObserver(this);
+	}
+
+	CancelPathRequests();
+	ReleaseAttackToken();
+}
+
+void AEnemy::ArmAITimer(FEnemyTimerHandle& Handle, EEnemyTimer Kind, float DelaySeconds)
+{
+	UEnemyAISubsystem* AISubsystem = GetWorld()->GetSubsystem<UEnemyAISubsystem>();
+	if (AISubsystem == nullptr) return;
+
+	AISubsystem->CancelTimer(Handle);
+	Handle = AISubsystem->ArmTimer(this, Kind, DelaySeconds);
+}
+
+void AEnemy::CancelAITimer(FEnemyTimerHandle& Handle)
+{
+	if (!Handle.IsSet()) return;
+
+	if (UEnemyAISubsystem* AISubsystem = GetWorld()->GetSubsystem<UEnemyAISubsystem>())
+	{
+		AISubsystem->CancelTimer(Handle);
+	}
+	Handle.Invalidate();
+}
+
 void AEnemy::ClearPatrolTimer()
 {
-	GetWorldTimerManager().ClearTimer(PatrolTimer);
+	CancelAITimer(PatrolTimer);
+	PausedPatrolWait = 0.f;
 }
 
 void AEnemy::StartAttackTimer()
 {
-	EnemyState = EEnemyState::EES_Attacking;
+	SetEnemyState(EEnemyState::EES_Attacking);
 
 	const float AttackTime = FMath::RandRange(AttackMin, AttackMax);
-	GetWorldTimerManager().SetTimer(
-		AttackTimer,
-		this,
-		&AEnemy::Attack,
-		AttackTime);
+	ArmAITimer(AttackTimer, EEnemyTimer::Attack, AttackTime);
 }
 
 void AEnemy::ClearAttackTimer()
 {
-	GetWorldTimerManager().ClearTimer(AttackTimer);
+	CancelAITimer(AttackTimer);
 }
 
-void AEnemy::SpawnDefaultWeapon()
+bool AEnemy::RequestAttackToken()
 {
-	UWorld* World = GetWorld();
+	UEnemyEngagementSubsystem* Engagement = GetWorld()->GetSubsystem<UEnemyEngagementSubsystem>();
+	if (Engagement == nullptr) return true;
 
-	if (World && WeaponClass)
+	if (Engagement->RequestToken(this, CombatTarget))
 	{
-		AWeapon* DefaultWeapon = World->SpawnActor<AWeapon>(WeaponClass);
-		DefaultWeapon->Equip(GetMesh(), FName("WeaponSocket"), this, this);
-		EquippedWeapon = DefaultWeapon;
+		bWaitingForAttackToken = false;
+		return true;
 	}
+
+	if (!bWaitingForAttackToken)
+	{
+		WaitForAttackToken();
+	}
+	return false;
 }
 
-void AEnemy::SpawnSoul()
+void AEnemy::ReleaseAttackToken()
 {
-	UWorld* World = GetWorld();
+	bWaitingForAttackToken = false;
 
-	if (World && SoulClass && Attributes)
+	if (UEnemyEngagementSubsystem* Engagement = GetWorld()->GetSubsystem<UEnemyEngagementSubsystem>())
 	{
-		const FVector SpawnLocation = GetActorLocation() + FVector(0.f, 0.f, 25.f);
-		ASoul* SpawnedSoul =
-			World->SpawnActor<ASoul>(SoulClass, SpawnLocation, GetActorRotation());
+		Engagement->ReleaseToken(this);
+	}
+}
+
+void AEnemy::WaitForAttackToken()
+{
+	bWaitingForAttackToken = true;
 
-		if (SpawnedSoul)
+	// Nothing else moves a waiter; the engagement subsystem circles it instead
+	SetEnemyState(EEnemyState::EES_WaitingForToken);
+	CancelPathRequests();
+
+	if (EnemyController)
+	{
+		EnemyController->StopMovement();
+	}
+
+	GetCharacterMovement()->MaxWalkSpeed = PatrollingSpeed;
+}
+
+void AEnemy::SpawnDefaultWeapon()
+{
+	UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+
+	if (Pool && WeaponClass)
+	{
+		AWeapon* DefaultWeapon = Pool->Acquire<AWeapon>(WeaponClass, GetActorTransform());
+		if (DefaultWeapon)
 		{
-			SpawnedSoul->SetSouls(Attributes->GetSouls());
+			DefaultWeapon->Equip(GetMesh(), FName("WeaponSocket"), this, this);
+			EquippedWeapon = DefaultWeapon;
 		}
 	}
 }
 
+void AEnemy::SpawnSoul()
+{
+	ULootAggregationSubsystem* Loot = GetWorld()->GetSubsystem<ULootAggregationSubsystem>();
+
+	if (Loot && SoulClass && Attributes)
+	{
+		// A pack dying together leaves one soul carrying all of their souls
+		const FVector SpawnLocation = GetActorLocation() + FVector(0.f, 0.f, 25.f);
+		Loot->DropSouls(SoulClass, FTransform(GetActorRotation(), SpawnLocation), Attributes->GetSouls());
+	}
+}
+
 /* =====================================================
  * Navigation Helpers
  * ===================================================== */
@@ -428,6 +712,13 @@ void AEnemy::MoveToTarget(AActor* Target)
 {
 	if (EnemyController == nullptr || Target == nullptr) return;
 
+	// Scheduled and pathed asynchronously, so a whole pack aggroing at once doesn't stall the frame
+	if (UEnemyPathSubsystem* PathSubsystem = GetWorld()->GetSubsystem<UEnemyPathSubsystem>())
+	{
+		PathSubsystem->RequestMove(this, Target, AcceptanceRadius);
+		return;
+	}
+
 	FAIMoveRequest MoveRequest;
 	MoveRequest.SetGoalActor(Target);
 	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
@@ -436,40 +727,69 @@ void AEnemy::MoveToTarget(AActor* Target)
 	EnemyController->MoveTo(MoveRequest, &NavPath);
 }
 
+void AEnemy::CancelPathRequests()
+{
+	if (UEnemyPathSubsystem* PathSubsystem = GetWorld()->GetSubsystem<UEnemyPathSubsystem>())
+	{
+		PathSubsystem->CancelRequests(this);
+	}
+}
+
 bool AEnemy::InTargetRange(AActor* Target, double Radius)
 {
 	if (Target == nullptr) return false;
 
-	const double DistanceToTarget =
-		(Target->GetActorLocation() - GetActorLocation()).Size();
+	const double DistSquaredToTarget =
+		FVector::DistSquared(Target->GetActorLocation(), GetActorLocation());
 
-	return DistanceToTarget <= Radius;
+	return DistSquaredToTarget <= FMath::Square(Radius);
 }
 
 AActor* AEnemy::ChoosePatrolTarget()
 {
-	TArray<AActor*> ValidTargets;
+	if (PatrolRoute && PatrolRoute->GetNumWaypoints() > 0)
+	{
+		PatrolWaypointIndex = PatrolRoute->ChooseNextWaypoint(PatrolWaypointIndex);
+		return PatrolRoute->GetWaypoint(PatrolWaypointIndex);
+	}
 
+	// No route: pick uniformly among the other targets without building a candidate list
+	int32 NumCandidates = 0;
 	for (AActor* Target : PatrolTargets)
 	{
 		if (Target != PatrolTarget)
 		{
-			ValidTargets.AddUnique(Target);
+			++NumCandidates;
 		}
 	}
 
-	const int32 NumTargets = ValidTargets.Num();
-	if (NumTargets > 0)
+	if (NumCandidates == 0) return nullptr;
+
+	int32 Selection = FMath::RandRange(0, NumCandidates - 1);
+	for (AActor* Target : PatrolTargets)
 	{
-		const int32 Selection = FMath::RandRange(0, NumTargets - 1);
-		return ValidTargets[Selection];
+		if (Target != PatrolTarget && Selection-- == 0)
+		{
+			return Target;
+		}
 	}
 
 	return nullptr;
 }
 
+AActor* AEnemy::ChooseFirstPatrolTarget()
+{
+	if (PatrolRoute && PatrolRoute->GetNumWaypoints() > 0)
+	{
+		PatrolWaypointIndex = 0;
+		return PatrolRoute->GetWaypoint(PatrolWaypointIndex);
+	}
+
+	return PatrolTargets.Num() > 0 ? PatrolTargets[0] : nullptr;
+}
+
 /* =====================================================
- * Pawn Sensing
+ * Perception
  * ===================================================== */
 
 void AEnemy::PawnSeen(APawn* SeenPawn)
@@ -483,11 +803,214 @@ void AEnemy::PawnSeen(APawn* SeenPawn)
 	if (bShouldChaseTarget)
 	{
 		CombatTarget = SeenPawn;
+		LastCombatTargetSeenTime = GetWorld()->GetTimeSeconds();
 		ClearPatrolTimer();
 		ChaseTarget();
 	}
 }
 
+void AEnemy::RefreshCombatTargetSight()
+{
+	if (CombatTarget == nullptr) return;
+
+	// Close enough to swing, or circling for a token: the target is never lost and needs no trace
+	if (IsWaitingForAttackToken() || IsInsideAttackRadius())
+	{
+		LastCombatTargetSeenTime = GetWorld()->GetTimeSeconds();
+		return;
+	}
+
+	UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>();
+	if (Perception == nullptr) return;
+
+	// Traced asynchronously, so the answer read here is from an earlier frame
+	Perception->RequestLineOfSight(this, CombatTarget);
+
+	bool bVisible = false;
+	double ResultTime = 0.0;
+	if (Perception->GetCachedLineOfSight(this, CombatTarget, bVisible, ResultTime) && bVisible)
+	{
+		LastCombatTargetSeenTime = FMath::Max(LastCombatTargetSeenTime, ResultTime);
+	}
+}
+
+bool AEnemy::HasLostSightOfCombatTarget() const
+{
+	return CombatTarget &&
+		GetWorld()->GetTimeSeconds() - LastCombatTargetSeenTime > LoseSightTime;
+}
+
+/* =====================================================
+ * Crowd
+ * ===================================================== */
+
+void AEnemy::SetPatrolTargets(const TArray<AActor*>& NewPatrolTargets, AActor* NewPatrolTarget)
+{
+	PatrolTargets = NewPatrolTargets;
+	PatrolTarget = NewPatrolTarget;
+}
+
+/* =====================================================
+ * Flow Field
+ * ===================================================== */
+
+void AEnemy::OnFlowFieldLost()
+{
+	if (EnemyState != EEnemyState::EES_Chasing) return;
+
+	MoveToTarget(CombatTarget);
+}
+
+/* =====================================================
+ * Engagement
+ * ===================================================== */
+
+void AEnemy::OnAttackTokenGranted()
+{
+	bWaitingForAttackToken = false;
+
+	if (IsDead() || CombatTarget == nullptr)
+	{
+		ReleaseAttackToken();
+		return;
+	}
+
+	if (IsInsideAttackRadius())
+	{
+		StartAttackTimer();
+	}
+	else
+	{
+		ChaseTarget();
+	}
+}
+
+/* =====================================================
+ * Pooling
+ * ===================================================== */
+
+void AEnemy::DeactivateForPool()
+{
+	bInPool = true;
+
+	ClearPatrolTimer();
+	ClearAttackTimer();
+	CancelAITimer(DeathTimer);
+
+	if (EnemyController)
+	{
+		EnemyController->StopMovement();
+	}
+
+	UnregisterFromAIServices();
+
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->UnregisterActor(this);
+	}
+
+	SetWeaponCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	GetMesh()->SetComponentTickEnabled(false);
+
+	if (EquippedWeapon)
+	{
+		EquippedWeapon->SetActorHiddenInGame(true);
+	}
+}
+
+void AEnemy::ActivateFromPool(const FTransform& SpawnTransform)
+{
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	ResetForReuse();
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	GetMesh()->SetComponentTickEnabled(true);
+
+	if (EquippedWeapon)
+	{
+		EquippedWeapon->SetActorHiddenInGame(false);
+	}
+	else
+	{
+		SpawnDefaultWeapon();
+	}
+
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->RegisterActor(this, GetSpatialCategory(), true);
+	}
+
+	RegisterWithAIServices();
+	bInPool = false;
+
+	StartPatrolling();
+}
+
+void AEnemy::ResetForReuse()
+{
+	if (Attributes)
+	{
+		Attributes->ResetAttributes();
+	}
+
+	SetEnemyState(EEnemyState::EES_Patrolling);
+	AILOD = EEnemyAILOD::EAL_Full;
+	CombatTarget = nullptr;
+	LastCombatTargetSeenTime = 0.0;
+	LastCombatCheckTime = 0.0;
+	bWaitingForAttackToken = false;
+
+	if (PatrolTarget == nullptr)
+	{
+		PatrolTarget = ChooseFirstPatrolTarget();
+	}
+
+	Tags.Remove(FName("Dead"));
+
+	if (HealthBarWidget)
+	{
+		HealthBarWidget->SetHealthPercent(1.f);
+	}
+	HideHealthBar();
+
+	// Die turned the capsule off, restore whatever the class authored
+	const AEnemy* Defaults = GetClass()->GetDefaultObject<AEnemy>();
+	GetCapsuleComponent()->SetCollisionEnabled(Defaults->GetCapsuleComponent()->GetCollisionEnabled());
+
+	GetCharacterMovement()->bOrientRotationToMovement = true;
+	GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_Walking);
+
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.f);
+	}
+
+	if (PawnSensing)
+	{
+		PawnSensing->SensingInterval = DefaultSensingInterval;
+	}
+}
+
+void AEnemy::DeathLifeSpanExpired()
+{
+	if (UEnemyPoolSubsystem* Pool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>())
+	{
+		Pool->ReleaseEnemy(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
 /* =====================================================
  * Debug
  * ===================================================== */
@@ -0,0 +1,417 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyAISubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "OpenWorldRPG.h"
+
+// =======================
+// Enemy
+// =======================
+#include "Enemy/Enemy.h"
+#include "Characters/SlashCharacter.h"
+
+/* =====================================================
+ * Console Variables
+ * ===================================================== */
+
+static TAutoConsoleVariable<float> CVarEnemyAIFrameBudgetMs(
+	TEXT("rpg.EnemyAI.FrameBudgetMs"),
+	1.0f,
+	TEXT("Game-thread time (ms) the enemy AI subsystem may spend updating enemies each frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarEnemyAIMinUpdatesPerFrame(
+	TEXT("rpg.EnemyAI.MinUpdatesPerFrame"),
+	4,
+	TEXT("Enemies always updated per frame, even when the time budget is exhausted."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyAIFullRateRadiusScale(
+	TEXT("rpg.EnemyAI.FullRateRadiusScale"),
+	1.5f,
+	TEXT("Enemies within CombatRadius times this scale of a player run at full AI rate."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyAIDormantRadiusScale(
+	TEXT("rpg.EnemyAI.DormantRadiusScale"),
+	6.f,
+	TEXT("Enemies beyond CombatRadius times this scale of every player go dormant."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyAIReducedUpdateInterval(
+	TEXT("rpg.EnemyAI.ReducedUpdateInterval"),
+	0.25f,
+	TEXT("Seconds between AI updates for enemies at reduced LOD."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyAIDormantCheckInterval(
+	TEXT("rpg.EnemyAI.DormantCheckInterval"),
+	1.f,
+	TEXT("Seconds between wake-up distance checks for dormant enemies."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarEnemyAIReportTimerChurn(
+	TEXT("rpg.EnemyAI.ReportTimerChurn"),
+	false,
+	TEXT("Log how many enemy AI timers were armed, cancelled and fired each frame."),
+	ECVF_Default);
+
+/* =====================================================
+ * Registration
+ * ===================================================== */
+
+void UEnemyAISubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr) return;
+
+	if (EntryIndices.Contains(Enemy)) return;
+
+	EntryIndices.Add(Enemy, Entries.Num());
+
+	FEnemyAIEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Enemy = Enemy;
+	Entry.LastUpdateTime = GetWorld()->GetTimeSeconds();
+	Entry.LOD = Enemy->GetAILOD();
+	Entry.StoreSlot = StateStore.AddEnemy(Enemy);
+
+	// Pooled enemies can come back mid-fight, the state change already happened
+	StateStore.SetInCombat(Entry.StoreSlot, Enemy->GetEnemyState() > EEnemyState::EES_Patrolling);
+}
+
+void UEnemyAISubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	int32 Index = INDEX_NONE;
+	if (!EntryIndices.RemoveAndCopyValue(Enemy, Index)) return;
+
+	// Entries are only cleared here and compacted before the next batch,
+	// so an enemy leaving mid-update never shifts the array under the loop
+	FEnemyAIEntry& Entry = Entries[Index];
+	StateStore.RemoveEnemy(Entry.StoreSlot);
+	Entry.StoreSlot = INDEX_NONE;
+	Entry.Enemy = nullptr;
+	bHasStaleEntries = true;
+}
+
+void UEnemyAISubsystem::SetEnemyInCombat(AEnemy* Enemy, bool bInCombat)
+{
+	if (const int32* Index = EntryIndices.Find(Enemy))
+	{
+		StateStore.SetInCombat(Entries[*Index].StoreSlot, bInCombat);
+	}
+}
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UEnemyAISubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	RPG_SCOPE_CYCLE_COUNTER(AIUpdate);
+
+	// Timers keep running when no enemy needs an update, e.g. the last one's death clean-up
+	AdvanceTimers(DeltaTime);
+
+	CompactEntries();
+
+	const int32 NumEntries = Entries.Num();
+	if (NumEntries == 0) return;
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double BudgetSeconds = CVarEnemyAIFrameBudgetMs.GetValueOnGameThread() / 1000.0;
+	const int32 MinUpdates = CVarEnemyAIMinUpdatesPerFrame.GetValueOnGameThread();
+	const double StartTime = FPlatformTime::Seconds();
+
+	RefreshPlayerLocations();
+	UpdateCombatRanges();
+
+	int32 NumUpdated = 0;
+
+	// Visit each entry at most once per frame, resuming where last frame stopped
+	for (int32 Visited = 0; Visited < NumEntries; ++Visited)
+	{
+		if (NumUpdated >= MinUpdates &&
+			FPlatformTime::Seconds() - StartTime >= BudgetSeconds)
+		{
+			break;
+		}
+
+		if (NextEntryIndex >= Entries.Num())
+		{
+			NextEntryIndex = 0;
+		}
+
+		FEnemyAIEntry& Entry = Entries[NextEntryIndex++];
+		AEnemy* Enemy = Entry.Enemy.Get();
+		if (Enemy == nullptr)
+		{
+			bHasStaleEntries = true;
+			continue;
+		}
+
+		// Dormant enemies only pay for a distance check, and only now and then
+		const bool bLODCheckDue =
+			Entry.LOD != EEnemyAILOD::EAL_Dormant ||
+			Now - Entry.LastLODCheckTime >= CVarEnemyAIDormantCheckInterval.GetValueOnGameThread();
+
+		if (bLODCheckDue)
+		{
+			Entry.LastLODCheckTime = Now;
+
+			const EEnemyAILOD NewLOD = ComputeLOD(Enemy, Entry.LOD);
+			if (NewLOD != Entry.LOD)
+			{
+				Entry.LOD = NewLOD;
+				Enemy->SetAILOD(NewLOD);
+			}
+		}
+
+		if (!IsUpdateDue(Entry, Now)) continue;
+
+		// Enemies skipped by the budget or LOD catch up with the full elapsed time
+		const float EnemyDeltaTime = static_cast<float>(Now - Entry.LastUpdateTime);
+		Entry.LastUpdateTime = Now;
+
+		Enemy->UpdateEnemy(EnemyDeltaTime);
+		++NumUpdated;
+	}
+}
+
+TStatId UEnemyAISubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyAISubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyAISubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Timers
+ * ===================================================== */
+
+FEnemyTimerHandle UEnemyAISubsystem::ArmTimer(AEnemy* Enemy, EEnemyTimer Kind, float DelaySeconds)
+{
+	return TimingWheel.Arm(Enemy, Kind, DelaySeconds);
+}
+
+void UEnemyAISubsystem::CancelTimer(FEnemyTimerHandle& Handle)
+{
+	TimingWheel.Cancel(Handle);
+}
+
+float UEnemyAISubsystem::GetTimerRemaining(const FEnemyTimerHandle& Handle) const
+{
+	return TimingWheel.GetRemaining(Handle);
+}
+
+void UEnemyAISubsystem::AdvanceTimers(float DeltaTime)
+{
+	FiredTimers.Reset();
+	TimingWheel.Advance(DeltaTime, FiredTimers);
+
+	// Handlers may arm or cancel timers, so they run after the wheel is done moving
+	for (const FEnemyTimingWheel::FFiredTimer& Fired : FiredTimers)
+	{
+		// An earlier handler this tick may have cancelled or re-armed this one
+		if (!TimingWheel.ConsumeFired(Fired.Handle)) continue;
+
+		if (AEnemy* Enemy = Fired.Enemy.Get())
+		{
+			Enemy->OnAITimerFired(Fired.Kind);
+		}
+	}
+
+	LastFrameTimerChurn = TimingWheel.GetChurn();
+	TimingWheel.ResetChurn();
+
+	if (CVarEnemyAIReportTimerChurn.GetValueOnGameThread())
+	{
+		UE_LOG(LogOpenWorldRPG, Display,
+			TEXT("EnemyAI timers: %d armed, %d cancelled, %d fired, %d pending"),
+			LastFrameTimerChurn.Armed,
+			LastFrameTimerChurn.Cancelled,
+			LastFrameTimerChurn.Fired,
+			TimingWheel.GetNumPending());
+	}
+}
+
+/* =====================================================
+ * Scheduling
+ * ===================================================== */
+
+bool UEnemyAISubsystem::IsUpdateDue(const FEnemyAIEntry& Entry, double Now) const
+{
+	switch (Entry.LOD)
+	{
+	case EEnemyAILOD::EAL_Full:
+		return true;
+
+	case EEnemyAILOD::EAL_Reduced:
+		return Now - Entry.LastUpdateTime >= CVarEnemyAIReducedUpdateInterval.GetValueOnGameThread();
+
+	default:
+		return false;
+	}
+}
+
+void UEnemyAISubsystem::CompactEntries()
+{
+	if (!bHasStaleEntries) return;
+
+	const int32 NumBefore = Entries.Num();
+	int32 NumRemovedBeforeCursor = 0;
+	int32 FirstRemoved = NumBefore;
+
+	for (int32 Index = 0; Index < NumBefore; ++Index)
+	{
+		FEnemyAIEntry& Entry = Entries[Index];
+		if (Entry.Enemy.IsValid()) continue;
+
+		FirstRemoved = FMath::Min(FirstRemoved, Index);
+
+		// Enemies collected without unregistering still hold a store slot
+		if (Entry.StoreSlot != INDEX_NONE)
+		{
+			StateStore.RemoveEnemy(Entry.StoreSlot);
+			Entry.StoreSlot = INDEX_NONE;
+		}
+
+		if (Index < NextEntryIndex)
+		{
+			++NumRemovedBeforeCursor;
+		}
+	}
+
+	Entries.RemoveAll([](const FEnemyAIEntry& Entry) { return !Entry.Enemy.IsValid(); });
+
+	// Garbage collected enemies never unregistered, so drop whatever no longer points at a live entry
+	for (auto It = EntryIndices.CreateIterator(); It; ++It)
+	{
+		if (It.Value() >= FirstRemoved)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// Only entries after the first removal shifted down
+	for (int32 Index = FirstRemoved; Index < Entries.Num(); ++Index)
+	{
+		EntryIndices.Add(Entries[Index].Enemy.Get(), Index);
+	}
+
+	// Keep the cursor on the same enemy so nobody is skipped or updated twice
+	NextEntryIndex = FMath::Max(0, NextEntryIndex - NumRemovedBeforeCursor);
+	bHasStaleEntries = false;
+}
+
+/* =====================================================
+ * Level of Detail
+ * ===================================================== */
+
+void UEnemyAISubsystem::RefreshPlayerLocations()
+{
+	PlayerLocations.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		const ASlashCharacter* SlashCharacter =
+			PlayerController ? Cast<ASlashCharacter>(PlayerController->GetPawn()) : nullptr;
+
+		if (SlashCharacter)
+		{
+			PlayerLocations.Add(SlashCharacter->GetActorLocation());
+		}
+	}
+}
+
+double UEnemyAISubsystem::GetDistSquaredToNearestPlayer(const FVector& Location) const
+{
+	double NearestDistSquared = TNumericLimits<double>::Max();
+
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		NearestDistSquared = FMath::Min(NearestDistSquared, FVector::DistSquared(Location, PlayerLocation));
+	}
+
+	return NearestDistSquared;
+}
+
+EEnemyAILOD UEnemyAISubsystem::ComputeLOD(const AEnemy* Enemy, EEnemyAILOD CurrentLOD) const
+{
+	// Waiting for an attack token only needs the occasional check, the engagement subsystem moves it
+	if (Enemy->IsWaitingForAttackToken())
+	{
+		return EEnemyAILOD::EAL_Reduced;
+	}
+
+	// Anything else fighting stays at full rate until it loses interest
+	if (Enemy->GetEnemyState() > EEnemyState::EES_Patrolling)
+	{
+		return EEnemyAILOD::EAL_Full;
+	}
+
+	const double DistSquared = GetDistSquaredToNearestPlayer(Enemy->GetActorLocation());
+
+	const double FullRadius = Enemy->GetCombatRadius() * CVarEnemyAIFullRateRadiusScale.GetValueOnGameThread();
+	const double DormantRadius = Enemy->GetCombatRadius() * CVarEnemyAIDormantRadiusScale.GetValueOnGameThread();
+
+	// PatrolRadius doubles as hysteresis so enemies on a tier boundary don't flicker
+	const double Hysteresis = Enemy->GetPatrolRadius();
+	const double FullExit = CurrentLOD == EEnemyAILOD::EAL_Full ? FullRadius + Hysteresis : FullRadius;
+	const double DormantEnter = CurrentLOD == EEnemyAILOD::EAL_Dormant ? DormantRadius : DormantRadius + Hysteresis;
+
+	if (DistSquared <= FMath::Square(FullExit))
+	{
+		return EEnemyAILOD::EAL_Full;
+	}
+
+	if (DistSquared <= FMath::Square(DormantEnter))
+	{
+		return EEnemyAILOD::EAL_Reduced;
+	}
+
+	return EEnemyAILOD::EAL_Dormant;
+}
+
+/* =====================================================
+ * Batched Range Checks
+ * ===================================================== */
+
+void UEnemyAISubsystem::UpdateCombatRanges()
+{
+	// Patrolling enemies were cleared when they left combat and are never touched here
+	for (const int32 Slot : StateStore.GetCombatSlots())
+	{
+		const AEnemy* Enemy = StateStore.GetEnemy(Slot);
+		if (Enemy == nullptr) continue;
+
+		StateStore.SyncSlot(
+			Slot,
+			Enemy->GetActorLocation(),
+			Enemy->GetCombatTarget(),
+			Enemy->GetAttackRadius(),
+			Enemy->GetCombatRadius());
+	}
+
+	StateStore.Classify();
+
+	for (const int32 Slot : StateStore.GetRangeChanges())
+	{
+		const EEnemyRangeClass NewRangeClass = StateStore.GetRangeClass(Slot);
+		AEnemy* Enemy = StateStore.GetEnemy(Slot);
+
+		if (Enemy && NewRangeClass != EEnemyRangeClass::NoTarget)
+		{
+			Enemy->OnCombatRangeChanged(NewRangeClass);
+		}
+	}
+}
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyAvoidance.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "HAL/IConsoleManager.h"
+#include "Components/CapsuleComponent.h"
+
+// =======================
+// Enemy / Spatial
+// =======================
+#include "Enemy/Enemy.h"
+#include "Spatial/SpatialHashSubsystem.h"
+
+/* =====================================================
+ * Console Variables
+ * ===================================================== */
+
+static TAutoConsoleVariable<bool> CVarAvoidanceEnabled(
+	TEXT("rpg.Avoidance.Enabled"),
+	true,
+	TEXT("Steer chasing enemies around each other before they collide."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAvoidanceNeighborRadius(
+	TEXT("rpg.Avoidance.NeighborRadius"),
+	300.f,
+	TEXT("Enemies within this distance are considered for avoidance."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAvoidanceTimeHorizon(
+	TEXT("rpg.Avoidance.TimeHorizon"),
+	0.75f,
+	TEXT("Seconds ahead an enemy looks for collisions with its neighbours."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAvoidanceSeparationWeight(
+	TEXT("rpg.Avoidance.SeparationWeight"),
+	1.f,
+	TEXT("Strength of the push between enemies that already overlap."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAvoidanceMaxNeighbors(
+	TEXT("rpg.Avoidance.MaxNeighbors"),
+	8,
+	TEXT("Neighbours each enemy reacts to per frame."),
+	ECVF_Default);
+
+/* =====================================================
+ * Steering
+ * ===================================================== */
+
+void FEnemyAvoidance::ComputeSteering(
+	const USpatialHashSubsystem& SpatialHash,
+	TArrayView<const FAgent> Agents,
+	TArray<FVector>& OutVelocities)
+{
+	OutVelocities.SetNumUninitialized(Agents.Num());
+
+	if (!CVarAvoidanceEnabled.GetValueOnGameThread())
+	{
+		for (int32 Index = 0; Index < Agents.Num(); ++Index)
+		{
+			OutVelocities[Index] = Agents[Index].DesiredVelocity;
+		}
+		return;
+	}
+
+	const double NeighborRadius = CVarAvoidanceNeighborRadius.GetValueOnGameThread();
+	const double TimeHorizon = FMath::Max(0.05f, CVarAvoidanceTimeHorizon.GetValueOnGameThread());
+	const double SeparationWeight = CVarAvoidanceSeparationWeight.GetValueOnGameThread();
+	const int32 MaxNeighbors = CVarAvoidanceMaxNeighbors.GetValueOnGameThread();
+
+	for (int32 Index = 0; Index < Agents.Num(); ++Index)
+	{
+		const FAgent& Agent = Agents[Index];
+		const FVector Velocity = Agent.DesiredVelocity;
+		FVector Steering = FVector::ZeroVector;
+		int32 NumNeighbors = 0;
+
+		SpatialHash.ForEachInRadius(Agent.Location, NeighborRadius, ESpatialCategory::Enemy,
+			[&](AActor* Actor, double DistSquared)
+			{
+				if (Actor == Agent.Enemy || NumNeighbors >= MaxNeighbors) return;
+
+				const AEnemy* Neighbor = Cast<AEnemy>(Actor);
+				if (Neighbor == nullptr || Neighbor->IsInPool() || Neighbor->GetEnemyState() == EEnemyState::EES_Dead) return;
+
+				++NumNeighbors;
+
+				const FVector Offset = (Neighbor->GetActorLocation() - Agent.Location) * FVector(1.0, 1.0, 0.0);
+				const double CombinedRadius = Agent.Radius + Neighbor->GetCapsuleComponent()->GetScaledCapsuleRadius();
+				const double Distance = Offset.Size();
+
+				// Already touching, push straight apart
+				if (Distance < CombinedRadius)
+				{
+					const FVector Away = Distance > UE_KINDA_SMALL_NUMBER
+						? -Offset / Distance
+						: FVector(FMath::Cos(Index), FMath::Sin(Index), 0.0);
+
+					Steering += Away * Agent.MaxSpeed * SeparationWeight * (1.0 - Distance / CombinedRadius);
+					return;
+				}
+
+				// Closest approach along the relative velocity, within the horizon
+				const FVector RelativeVelocity = (Velocity - Neighbor->GetVelocity()) * FVector(1.0, 1.0, 0.0);
+				const double RelativeSpeedSquared = RelativeVelocity.SizeSquared();
+				if (RelativeSpeedSquared < UE_KINDA_SMALL_NUMBER) return;
+
+				const double TimeToClosest = FVector::DotProduct(Offset, RelativeVelocity) / RelativeSpeedSquared;
+				if (TimeToClosest <= 0.0 || TimeToClosest > TimeHorizon) return;
+
+				const FVector ClosestOffset = Offset - RelativeVelocity * TimeToClosest;
+				const double ClosestDistance = ClosestOffset.Size();
+				if (ClosestDistance >= CombinedRadius) return;
+
+				// Sidestep away from the point of closest approach; both enemies
+				// do the same, so each takes half of the correction
+				const FVector Sidestep = ClosestDistance > UE_KINDA_SMALL_NUMBER
+					? -ClosestOffset / ClosestDistance
+					: FVector(-RelativeVelocity.Y, RelativeVelocity.X, 0.0).GetSafeNormal();
+
+				const double Urgency = 1.0 - TimeToClosest / TimeHorizon;
+				Steering += Sidestep * (CombinedRadius - ClosestDistance) / TimeToClosest * Urgency * 0.5;
+			});
+
+		OutVelocities[Index] = (Velocity + Steering).GetClampedToMaxSize(Agent.MaxSpeed);
+	}
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyCrowdSpawner.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "Components/InstancedStaticMeshComponent.h"
+#include "NavigationSystem.h"
+
+// =======================
+// Enemy
+// =======================
+#include "Enemy/EnemyCrowdSubsystem.h"
+
+/* =====================================================
+ * Constructor
+ * ===================================================== */
+
+AEnemyCrowdSpawner::AEnemyCrowdSpawner()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	CrowdMesh = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("CrowdMesh"));
+	SetRootComponent(CrowdMesh);
+
+	// Pure visuals, the real enemies handle collision once promoted
+	CrowdMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CrowdMesh->SetCanEverAffectNavigation(false);
+	CrowdMesh->SetGenerateOverlapEvents(false);
+}
+
+/* =====================================================
+ * <Actor> Overrides
+ * ===================================================== */
+
+void AEnemyCrowdSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (EnemyClass == nullptr || NumAgents <= 0) return;
+
+	TArray<FVector> SpawnLocations;
+	GenerateSpawnLocations(SpawnLocations);
+
+	TArray<FTransform> InstanceTransforms;
+	InstanceTransforms.Reserve(SpawnLocations.Num());
+
+	for (const FVector& Location : SpawnLocations)
+	{
+		InstanceTransforms.Emplace(FRotator(0.f, MeshYawOffset, 0.f), Location);
+	}
+
+	// Instance N is agent N, the subsystem relies on that ordering
+	CrowdMesh->ClearInstances();
+	CrowdMesh->AddInstances(InstanceTransforms, false, true);
+
+	if (UEnemyCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UEnemyCrowdSubsystem>())
+	{
+		Crowd->RegisterSpawner(this, SpawnLocations);
+	}
+}
+
+void AEnemyCrowdSpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UEnemyCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UEnemyCrowdSubsystem>())
+	{
+		Crowd->UnregisterSpawner(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AEnemyCrowdSpawner::GenerateSpawnLocations(TArray<FVector>& OutLocations) const
+{
+	const FVector Origin = GetActorLocation();
+	const UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	OutLocations.Reset(NumAgents);
+
+	for (int32 Agent = 0; Agent < NumAgents; ++Agent)
+	{
+		FNavLocation NavLocation;
+		if (NavSystem && NavSystem->GetRandomReachablePointInRadius(Origin, SpawnRadius, NavLocation))
+		{
+			OutLocations.Add(NavLocation.Location);
+		}
+		else
+		{
+			OutLocations.Add(Origin + FVector(FMath::RandPointInCircle(SpawnRadius), 0.f));
+		}
+	}
+}
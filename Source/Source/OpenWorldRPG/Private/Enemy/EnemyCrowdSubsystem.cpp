@@ -0,0 +1,418 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyCrowdSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+// =======================
+// AI
+// =======================
+#include "Perception/PawnSensingComponent.h"
+
+// =======================
+// Enemy
+// =======================
+#include "Enemy/Enemy.h"
+#include "Enemy/EnemyCrowdSpawner.h"
+#include "Enemy/EnemyPoolSubsystem.h"
+#include "Characters/SlashCharacter.h"
+
+/* =====================================================
+ * Console Variables
+ * ===================================================== */
+
+static TAutoConsoleVariable<int32> CVarCrowdMaxPromotionsPerFrame(
+	TEXT("rpg.Crowd.MaxPromotionsPerFrame"),
+	4,
+	TEXT("Crowd agents that may be turned into full enemies in a single frame."),
+	ECVF_Default);
+
+/* =====================================================
+ * Registration
+ * ===================================================== */
+
+void UEnemyCrowdSubsystem::RegisterSpawner(AEnemyCrowdSpawner* Spawner, const TArray<FVector>& SpawnLocations)
+{
+	if (Spawner == nullptr || Spawner->GetEnemyClass() == nullptr) return;
+
+	const AEnemy* Defaults = Spawner->GetEnemyClass()->GetDefaultObject<AEnemy>();
+
+	FCrowdGroup& Group = Groups.AddDefaulted_GetRef();
+	Group.Spawner = Spawner;
+	Group.EnemyClass = Spawner->GetEnemyClass();
+	Group.PatrollingSpeed = Defaults->GetPatrollingSpeed();
+	Group.ChasingSpeed = Defaults->GetChasingSpeed();
+	Group.PatrolWaitMin = Defaults->GetPatrolWaitMin();
+	Group.PatrolWaitMax = Defaults->GetPatrolWaitMax();
+	Group.CombatRadius = Defaults->GetCombatRadius();
+	Group.PatrolRadius = Defaults->GetPatrolRadius();
+	Group.SightRadius = Defaults->GetPawnSensing() ? Defaults->GetPawnSensing()->SightRadius : Group.CombatRadius;
+	Group.SpawnHeight = Defaults->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	for (const AActor* PatrolTarget : Spawner->GetPatrolTargets())
+	{
+		// Null entries keep their slot so indices match the spawner's array
+		Group.PatrolPoints.Add(PatrolTarget ? PatrolTarget->GetActorLocation() : Spawner->GetActorLocation());
+	}
+
+	const int32 NumAgents = SpawnLocations.Num();
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	Group.Positions = SpawnLocations;
+	Group.Yaws.Init(0.f, NumAgents);
+	Group.States.Init(EEnemyState::EES_Patrolling, NumAgents);
+	Group.PatrolIndices.Init(0, NumAgents);
+	Group.WaitUntil.Init(Now, NumAgents);
+	Group.IsPromoted.Init(0, NumAgents);
+	Group.PromotedEnemies.SetNum(NumAgents);
+	Group.IsDirty.Init(1, NumAgents);
+
+	for (int32 Agent = 0; Agent < NumAgents; ++Agent)
+	{
+		// Start spread over the route so the crowd doesn't walk in one column
+		Group.PatrolIndices[Agent] =
+			Group.PatrolPoints.Num() > 0 ? Random.RandHelper(Group.PatrolPoints.Num()) : INDEX_NONE;
+	}
+}
+
+void UEnemyCrowdSubsystem::UnregisterSpawner(AEnemyCrowdSpawner* Spawner)
+{
+	// Promoted enemies stay in the world, they are ordinary enemies now
+	Groups.RemoveAll([Spawner](const FCrowdGroup& Group)
+	{
+		return Group.Spawner.Get() == Spawner;
+	});
+
+	NumPromoted = 0;
+	for (const FCrowdGroup& Group : Groups)
+	{
+		for (const uint8 Promoted : Group.IsPromoted)
+		{
+			NumPromoted += Promoted;
+		}
+	}
+}
+
+int32 UEnemyCrowdSubsystem::GetNumAgents() const
+{
+	int32 NumAgents = 0;
+
+	for (const FCrowdGroup& Group : Groups)
+	{
+		NumAgents += Group.Positions.Num();
+	}
+
+	return NumAgents;
+}
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UEnemyCrowdSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	Groups.RemoveAll([](const FCrowdGroup& Group) { return !Group.Spawner.IsValid(); });
+	if (Groups.Num() == 0) return;
+
+	RefreshPlayers();
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Spawning a full enemy is expensive, so a crowd walking into view is promoted over several frames
+	int32 PromotionsLeft = CVarCrowdMaxPromotionsPerFrame.GetValueOnGameThread();
+
+	for (FCrowdGroup& Group : Groups)
+	{
+		const double PromoteRadiusSquared = FMath::Square(Group.CombatRadius);
+
+		for (int32 Agent = 0; Agent < Group.Positions.Num(); ++Agent)
+		{
+			if (Group.States[Agent] == EEnemyState::EES_Dead) continue;
+
+			if (Group.IsPromoted[Agent])
+			{
+				UpdatePromotedAgent(Group, Agent, Now);
+				continue;
+			}
+
+			double DistSquared = 0.0;
+			const int32 NearestPlayer = FindNearestPlayer(Group.Positions[Agent], DistSquared);
+
+			SimulateAgent(Group, Agent, NearestPlayer, DistSquared, DeltaTime, Now);
+
+			if (NearestPlayer != INDEX_NONE && DistSquared <= PromoteRadiusSquared && PromotionsLeft > 0)
+			{
+				PromoteAgent(Group, Agent, Players[NearestPlayer].Get());
+				--PromotionsLeft;
+			}
+		}
+
+		PushInstanceTransforms(Group);
+	}
+}
+
+TStatId UEnemyCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyCrowdSubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyCrowdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Agents
+ * ===================================================== */
+
+void UEnemyCrowdSubsystem::SimulateAgent(
+	FCrowdGroup& Group,
+	int32 Agent,
+	int32 NearestPlayer,
+	double DistSquared,
+	float DeltaTime,
+	double Now)
+{
+	FVector& Position = Group.Positions[Agent];
+	EEnemyState& State = Group.States[Agent];
+
+	// Same thresholds AEnemy uses: spot inside sight range, give up past it
+	const bool bPlayerInSight = NearestPlayer != INDEX_NONE && DistSquared <= FMath::Square(Group.SightRadius);
+	const bool bPlayerLost = NearestPlayer == INDEX_NONE || DistSquared > FMath::Square(Group.SightRadius + Group.PatrolRadius);
+
+	if (State == EEnemyState::EES_Patrolling && bPlayerInSight)
+	{
+		State = EEnemyState::EES_Chasing;
+	}
+	else if (State == EEnemyState::EES_Chasing && bPlayerLost)
+	{
+		State = EEnemyState::EES_Patrolling;
+		Group.WaitUntil[Agent] = Now;
+	}
+
+	FVector Goal;
+	float Speed;
+
+	if (State == EEnemyState::EES_Chasing)
+	{
+		// Stay on the ground rather than climbing to the player's capsule centre
+		Goal = FVector(PlayerLocations[NearestPlayer].X, PlayerLocations[NearestPlayer].Y, Position.Z);
+		Speed = Group.ChasingSpeed;
+	}
+	else
+	{
+		const int32 PatrolIndex = Group.PatrolIndices[Agent];
+		if (PatrolIndex == INDEX_NONE || Now < Group.WaitUntil[Agent]) return;
+
+		Goal = Group.PatrolPoints[PatrolIndex];
+		Speed = Group.PatrollingSpeed;
+
+		if (FVector::DistSquared2D(Position, Goal) <= FMath::Square(Group.PatrolRadius))
+		{
+			// Arrived: pick the next point and idle like an enemy's patrol timer
+			ChooseNextPatrolPoint(Group, Agent);
+			Group.WaitUntil[Agent] = Now + Random.FRandRange(Group.PatrolWaitMin, Group.PatrolWaitMax);
+			return;
+		}
+	}
+
+	const FVector ToGoal = Goal - Position;
+	const double Distance = ToGoal.Size();
+	if (Distance <= UE_KINDA_SMALL_NUMBER) return;
+
+	const double Step = FMath::Min(Distance, static_cast<double>(Speed) * DeltaTime);
+	Position += ToGoal * (Step / Distance);
+	Group.Yaws[Agent] = static_cast<float>(FMath::RadiansToDegrees(FMath::Atan2(ToGoal.Y, ToGoal.X)));
+	Group.IsDirty[Agent] = 1;
+}
+
+void UEnemyCrowdSubsystem::ChooseNextPatrolPoint(FCrowdGroup& Group, int32 Agent)
+{
+	const int32 NumPoints = Group.PatrolPoints.Num();
+	int32& PatrolIndex = Group.PatrolIndices[Agent];
+
+	if (NumPoints < 2) return;
+
+	// Uniform over every point except the current one, without building a candidate list
+	const int32 Selection = Random.RandHelper(NumPoints - 1);
+	PatrolIndex = Selection >= PatrolIndex ? Selection + 1 : Selection;
+}
+
+void UEnemyCrowdSubsystem::PromoteAgent(FCrowdGroup& Group, int32 Agent, APawn* NearestPlayer)
+{
+	AEnemyCrowdSpawner* Spawner = Group.Spawner.Get();
+	if (Spawner == nullptr) return;
+
+	const FTransform SpawnTransform(
+		FRotator(0.f, Group.Yaws[Agent], 0.f),
+		Group.Positions[Agent] + FVector(0.f, 0.f, Group.SpawnHeight));
+
+	UEnemyPoolSubsystem* Pool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>();
+	if (Pool == nullptr) return;
+
+	const TArray<AActor*>& PatrolTargets = Spawner->GetPatrolTargets();
+	const int32 PatrolIndex = Group.PatrolIndices[Agent];
+	AActor* PatrolTarget = PatrolTargets.IsValidIndex(PatrolIndex) ? PatrolTargets[PatrolIndex] : nullptr;
+
+	AEnemy* Enemy = Pool->AcquireEnemy(Group.EnemyClass, SpawnTransform, [&PatrolTargets, PatrolTarget](AEnemy& NewEnemy)
+	{
+		NewEnemy.SetPatrolTargets(PatrolTargets, PatrolTarget);
+	});
+
+	if (Enemy == nullptr) return;
+
+	// A chasing agent hands its target straight over instead of waiting to be seen again
+	if (Group.States[Agent] == EEnemyState::EES_Chasing && NearestPlayer)
+	{
+		Enemy->PawnSeen(NearestPlayer);
+	}
+
+	Group.IsPromoted[Agent] = 1;
+	Group.PromotedEnemies[Agent] = Enemy;
+	Group.IsDirty[Agent] = 1;
+	++NumPromoted;
+}
+
+void UEnemyCrowdSubsystem::UpdatePromotedAgent(FCrowdGroup& Group, int32 Agent, double Now)
+{
+	AEnemy* Enemy = Group.PromotedEnemies[Agent].Get();
+
+	// Killed, pooled or removed by something else: this agent is gone for good
+	if (Enemy == nullptr || Enemy->IsInPool() || Enemy->GetEnemyState() == EEnemyState::EES_Dead)
+	{
+		Group.States[Agent] = EEnemyState::EES_Dead;
+		Group.IsPromoted[Agent] = 0;
+		Group.PromotedEnemies[Agent] = nullptr;
+		--NumPromoted;
+		return;
+	}
+
+	// Only a calm enemy goes back into the crowd
+	if (Enemy->GetEnemyState() != EEnemyState::EES_Patrolling) return;
+
+	double DistSquared = 0.0;
+	const FVector EnemyLocation = Enemy->GetActorLocation();
+	const int32 NearestPlayer = FindNearestPlayer(EnemyLocation, DistSquared);
+
+	// PatrolRadius doubles as hysteresis so an agent on the boundary doesn't respawn every frame
+	if (NearestPlayer != INDEX_NONE && DistSquared <= FMath::Square(Group.CombatRadius + Group.PatrolRadius)) return;
+
+	const AEnemyCrowdSpawner* Spawner = Group.Spawner.Get();
+	const int32 PatrolIndex = Spawner ? Spawner->GetPatrolTargets().IndexOfByKey(Enemy->GetPatrolTarget()) : INDEX_NONE;
+
+	Group.Positions[Agent] = EnemyLocation - FVector(0.f, 0.f, Group.SpawnHeight);
+	Group.Yaws[Agent] = static_cast<float>(Enemy->GetActorRotation().Yaw);
+	Group.States[Agent] = EEnemyState::EES_Patrolling;
+	Group.WaitUntil[Agent] = Now;
+
+	if (PatrolIndex != INDEX_NONE)
+	{
+		Group.PatrolIndices[Agent] = PatrolIndex;
+	}
+
+	Group.IsPromoted[Agent] = 0;
+	Group.PromotedEnemies[Agent] = nullptr;
+	Group.IsDirty[Agent] = 1;
+	--NumPromoted;
+
+	if (UEnemyPoolSubsystem* Pool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>())
+	{
+		Pool->ReleaseEnemy(Enemy);
+	}
+	else
+	{
+		Enemy->Destroy();
+	}
+}
+
+void UEnemyCrowdSubsystem::PushInstanceTransforms(FCrowdGroup& Group)
+{
+	AEnemyCrowdSpawner* Spawner = Group.Spawner.Get();
+	UInstancedStaticMeshComponent* CrowdMesh = Spawner ? Spawner->GetCrowdMesh() : nullptr;
+	if (CrowdMesh == nullptr) return;
+
+	const int32 NumAgents = Group.Positions.Num();
+	const float MeshYawOffset = Spawner->GetMeshYawOffset();
+
+	bool bPushedAny = false;
+
+	// Idle and waiting agents are skipped, only contiguous runs of dirty ones are uploaded
+	for (int32 RunStart = 0; RunStart < NumAgents; ++RunStart)
+	{
+		if (!Group.IsDirty[RunStart]) continue;
+
+		Group.InstanceTransforms.Reset();
+
+		int32 Agent = RunStart;
+		for (; Agent < NumAgents && Group.IsDirty[Agent]; ++Agent)
+		{
+			// Promoted and dead agents keep their instance, collapsed to nothing
+			const bool bHidden = Group.IsPromoted[Agent] || Group.States[Agent] == EEnemyState::EES_Dead;
+
+			Group.InstanceTransforms.Add(FTransform(
+				FRotator(0.f, Group.Yaws[Agent] + MeshYawOffset, 0.f),
+				Group.Positions[Agent],
+				bHidden ? FVector::ZeroVector : FVector::OneVector));
+
+			Group.IsDirty[Agent] = 0;
+		}
+
+		CrowdMesh->BatchUpdateInstancesTransforms(RunStart, Group.InstanceTransforms, true, false, true);
+		bPushedAny = true;
+		RunStart = Agent;
+	}
+
+	if (bPushedAny)
+	{
+		CrowdMesh->MarkRenderStateDirty();
+	}
+}
+
+/* =====================================================
+ * Players
+ * ===================================================== */
+
+void UEnemyCrowdSubsystem::RefreshPlayers()
+{
+	Players.Reset();
+	PlayerLocations.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		ASlashCharacter* SlashCharacter =
+			PlayerController ? Cast<ASlashCharacter>(PlayerController->GetPawn()) : nullptr;
+
+		if (SlashCharacter)
+		{
+			Players.Add(SlashCharacter);
+			PlayerLocations.Add(SlashCharacter->GetActorLocation());
+		}
+	}
+}
+
+int32 UEnemyCrowdSubsystem::FindNearestPlayer(const FVector& Location, double& OutDistSquared) const
+{
+	int32 NearestPlayer = INDEX_NONE;
+	OutDistSquared = TNumericLimits<double>::Max();
+
+	for (int32 PlayerIndex = 0; PlayerIndex < PlayerLocations.Num(); ++PlayerIndex)
+	{
+		const double DistSquared = FVector::DistSquared(Location, PlayerLocations[PlayerIndex]);
+		if (DistSquared < OutDistSquared)
+		{
+			OutDistSquared = DistSquared;
+			NearestPlayer = PlayerIndex;
+		}
+	}
+
+	return NearestPlayer;
+}
@@ -0,0 +1,270 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyEngagementSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "OpenWorldRPG.h"
+
+// =======================
+// Enemy / Spatial
+// =======================
+#include "Enemy/Enemy.h"
+#include "Spatial/SpatialHashSubsystem.h"
+
+/* =====================================================
+ * Console Variables
+ * ===================================================== */
+
+static TAutoConsoleVariable<int32> CVarEngagementTokensPerTarget(
+	TEXT("rpg.Engagement.TokensPerTarget"),
+	2,
+	TEXT("Enemies allowed to attack the same target at once."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEngagementCircleMargin(
+	TEXT("rpg.Engagement.CircleMargin"),
+	150.f,
+	TEXT("How far outside AttackRadius waiting enemies circle their target."),
+	ECVF_Default);
+
+/* =====================================================
+ * Tokens
+ * ===================================================== */
+
+bool UEnemyEngagementSubsystem::RequestToken(AEnemy* Enemy, AActor* Target)
+{
+	if (Enemy == nullptr || Target == nullptr) return false;
+
+	// Switching targets gives up the place on the old one first
+	if (const TObjectKey<AActor>* CurrentTarget = EnemyTargets.Find(TWeakObjectPtr<AEnemy>(Enemy)))
+	{
+		if (*CurrentTarget != TObjectKey<AActor>(Target))
+		{
+			ReleaseToken(Enemy);
+		}
+	}
+
+	FEngagement& Engagement = Engagements.FindOrAdd(Target);
+	if (Engagement.Holders.Contains(Enemy)) return true;
+
+	EnemyTargets.Add(TWeakObjectPtr<AEnemy>(Enemy), TObjectKey<AActor>(Target));
+
+	// A free token only goes to a newcomer if nobody is queued ahead of it
+	const int32 TokensPerTarget = FMath::Max(1, CVarEngagementTokensPerTarget.GetValueOnGameThread());
+	const bool bFirstInLine = Engagement.Waiters.Num() == 0 || Engagement.Waiters[0].Get() == Enemy;
+
+	if (Engagement.Holders.Num() < TokensPerTarget && bFirstInLine)
+	{
+		Engagement.Waiters.Remove(Enemy);
+		Engagement.Holders.Add(Enemy);
+		return true;
+	}
+
+	Engagement.Waiters.AddUnique(Enemy);
+	return false;
+}
+
+void UEnemyEngagementSubsystem::ReleaseToken(AEnemy* Enemy)
+{
+	TObjectKey<AActor> TargetKey;
+	if (!EnemyTargets.RemoveAndCopyValue(TWeakObjectPtr<AEnemy>(Enemy), TargetKey)) return;
+
+	FEngagement* Engagement = Engagements.Find(TargetKey);
+	if (Engagement == nullptr) return;
+
+	Engagement->Waiters.Remove(Enemy);
+
+	if (Engagement->Holders.Remove(Enemy) > 0)
+	{
+		GrantWaitingTokens(*Engagement);
+		NotifyGranted();
+	}
+}
+
+double UEnemyEngagementSubsystem::GetWaitRadius(double AttackRadius)
+{
+	return AttackRadius + 2.0 * CVarEngagementCircleMargin.GetValueOnGameThread();
+}
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UEnemyEngagementSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	RPG_SCOPE_CYCLE_COUNTER(Engagement);
+
+	for (auto It = Engagements.CreateIterator(); It; ++It)
+	{
+		RefreshEngagement(It.Key(), It.Value());
+
+		if (It.Value().Holders.Num() == 0 && It.Value().Waiters.Num() == 0)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	NotifyGranted();
+	SteerWaiters();
+}
+
+TStatId UEnemyEngagementSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyEngagementSubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyEngagementSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Bookkeeping
+ * ===================================================== */
+
+void UEnemyEngagementSubsystem::RefreshEngagement(TObjectKey<AActor> TargetKey, FEngagement& Engagement)
+{
+	const AActor* Target = TargetKey.ResolveObjectPtr();
+
+	auto IsStale = [this, Target, TargetKey](const TWeakObjectPtr<AEnemy>& Entry, bool bHolder)
+	{
+		const AEnemy* Enemy = Entry.Get();
+
+		bool bStale =
+			Enemy == nullptr ||
+			Target == nullptr ||
+			Enemy->IsInPool() ||
+			Enemy->GetCombatTarget() != Target;
+
+		if (!bStale)
+		{
+			// Holders keep the token while closing in, winding up or swinging
+			const EEnemyState State = Enemy->GetEnemyState();
+			bStale = bHolder
+				? State < EEnemyState::EES_Chasing || Enemy->IsWaitingForAttackToken()
+				: State == EEnemyState::EES_Dead || !Enemy->IsWaitingForAttackToken();
+		}
+
+		// The enemy may already be queued on another target, leave that entry alone
+		if (bStale)
+		{
+			const TObjectKey<AActor>* QueuedTarget = EnemyTargets.Find(Entry);
+			if (QueuedTarget && *QueuedTarget == TargetKey)
+			{
+				EnemyTargets.Remove(Entry);
+			}
+		}
+		return bStale;
+	};
+
+	Engagement.Holders.RemoveAll([&IsStale](const TWeakObjectPtr<AEnemy>& Entry) { return IsStale(Entry, true); });
+	Engagement.Waiters.RemoveAll([&IsStale](const TWeakObjectPtr<AEnemy>& Entry) { return IsStale(Entry, false); });
+
+	GrantWaitingTokens(Engagement);
+}
+
+void UEnemyEngagementSubsystem::GrantWaitingTokens(FEngagement& Engagement)
+{
+	const int32 TokensPerTarget = FMath::Max(1, CVarEngagementTokensPerTarget.GetValueOnGameThread());
+
+	while (Engagement.Holders.Num() < TokensPerTarget && Engagement.Waiters.Num() > 0)
+	{
+		const TWeakObjectPtr<AEnemy> Waiter = Engagement.Waiters[0];
+		Engagement.Waiters.RemoveAt(0, 1, EAllowShrinking::No);
+
+		if (!Waiter.IsValid()) continue;
+
+		Engagement.Holders.Add(Waiter);
+		NewlyGranted.Add(Waiter);
+	}
+}
+
+void UEnemyEngagementSubsystem::NotifyGranted()
+{
+	if (NewlyGranted.Num() == 0) return;
+
+	// A granted enemy may release or request again, which can grant more
+	TArray<TWeakObjectPtr<AEnemy>> Granted = MoveTemp(NewlyGranted);
+	NewlyGranted.Reset();
+
+	for (const TWeakObjectPtr<AEnemy>& Entry : Granted)
+	{
+		if (AEnemy* Enemy = Entry.Get())
+		{
+			Enemy->OnAttackTokenGranted();
+		}
+	}
+}
+
+/* =====================================================
+ * Circling
+ * ===================================================== */
+
+void UEnemyEngagementSubsystem::SteerWaiters()
+{
+	AvoidanceAgents.Reset();
+
+	const double CircleMargin = CVarEngagementCircleMargin.GetValueOnGameThread();
+
+	for (const TPair<TObjectKey<AActor>, FEngagement>& Pair : Engagements)
+	{
+		const AActor* Target = Pair.Key.ResolveObjectPtr();
+		if (Target == nullptr) continue;
+
+		const FVector TargetLocation = Target->GetActorLocation();
+
+		for (const TWeakObjectPtr<AEnemy>& Entry : Pair.Value.Waiters)
+		{
+			AEnemy* Enemy = Entry.Get();
+			if (Enemy == nullptr) continue;
+
+			const FVector ToEnemy = (Enemy->GetActorLocation() - TargetLocation) * FVector(1.0, 1.0, 0.0);
+			const double Distance = ToEnemy.Size();
+			if (Distance < UE_KINDA_SMALL_NUMBER) continue;
+
+			// Walk around the ring, half the waiters each way, while easing back onto it
+			const FVector Radial = ToEnemy / Distance;
+			const double Side = (Enemy->GetUniqueID() & 1) ? 1.0 : -1.0;
+			const FVector Tangent = FVector(-Radial.Y, Radial.X, 0.0) * Side;
+
+			const double CircleRadius = Enemy->GetAttackRadius() + CircleMargin;
+			const double RadialPull = FMath::Clamp((CircleRadius - Distance) / FMath::Max(CircleMargin, 1.0), -1.0, 1.0);
+
+			FEnemyAvoidance::FAgent& Agent = AvoidanceAgents.AddDefaulted_GetRef();
+			Agent.Enemy = Enemy;
+			Agent.Location = Enemy->GetActorLocation();
+			Agent.Radius = Enemy->GetCapsuleComponent()->GetScaledCapsuleRadius();
+			Agent.MaxSpeed = Enemy->GetCharacterMovement()->GetMaxSpeed();
+			Agent.DesiredVelocity = (Tangent + Radial * RadialPull).GetSafeNormal() * Agent.MaxSpeed;
+		}
+	}
+
+	if (AvoidanceAgents.Num() == 0) return;
+
+	if (const USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		FEnemyAvoidance::ComputeSteering(*SpatialHash, AvoidanceAgents, SteeringVelocities);
+	}
+	else
+	{
+		SteeringVelocities.Reset();
+		for (const FEnemyAvoidance::FAgent& Agent : AvoidanceAgents)
+		{
+			SteeringVelocities.Add(Agent.DesiredVelocity);
+		}
+	}
+
+	for (int32 Index = 0; Index < AvoidanceAgents.Num(); ++Index)
+	{
+		const FEnemyAvoidance::FAgent& Agent = AvoidanceAgents[Index];
+		Agent.Enemy->AddMovementInput(SteeringVelocities[Index] / FMath::Max(Agent.MaxSpeed, 1.f));
+	}
+}
@@ -0,0 +1,489 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyFlowFieldSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "NavigationSystem.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "OpenWorldRPG.h"
+
+// =======================
+// Enemy
+// =======================
+#include "Enemy/Enemy.h"
+#include "Spatial/SpatialHashSubsystem.h"
+
+/* =====================================================
+ * Console Variables
+ * ===================================================== */
+
+static TAutoConsoleVariable<bool> CVarFlowFieldEnabled(
+	TEXT("rpg.FlowField.Enabled"),
+	true,
+	TEXT("Steer chasing enemies along a shared flow field instead of individual paths."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFlowFieldGridSize(
+	TEXT("rpg.FlowField.GridSize"),
+	64,
+	TEXT("Cells along each side of the flow field grid around the player."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFlowFieldCellSize(
+	TEXT("rpg.FlowField.CellSize"),
+	100.f,
+	TEXT("World size of one flow field cell."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFlowFieldSamplesPerFrame(
+	TEXT("rpg.FlowField.SamplesPerFrame"),
+	256,
+	TEXT("Navmesh projections the flow field may run each frame when its grid moves."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFlowFieldRebuildInterval(
+	TEXT("rpg.FlowField.RebuildInterval"),
+	0.2f,
+	TEXT("Minimum seconds between flow field rebuilds while the player moves."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFlowFieldProjectionHeight(
+	TEXT("rpg.FlowField.ProjectionHeight"),
+	300.f,
+	TEXT("Vertical reach when projecting flow field cells onto the navmesh."),
+	ECVF_Default);
+
+static constexpr uint8 WalkableCost = 1;
+static constexpr uint8 BlockedCost = 255;
+
+/* =====================================================
+ * Followers
+ * ===================================================== */
+
+bool UEnemyFlowFieldSubsystem::CanGuide(const AActor* Goal, const FVector& Location) const
+{
+	if (!CVarFlowFieldEnabled.GetValueOnGameThread()) return false;
+	if (Goal == nullptr || Goal != Target.Get()) return false;
+
+	FVector Direction;
+	return SampleDirection(Location, Direction);
+}
+
+void UEnemyFlowFieldSubsystem::AddFollower(AEnemy* Enemy)
+{
+	if (Enemy == nullptr) return;
+
+	Followers.AddUnique(Enemy);
+}
+
+bool UEnemyFlowFieldSubsystem::SampleDirection(const FVector& Location, FVector& OutDirection) const
+{
+	if (!FrontField.IsValid()) return false;
+
+	const FFlowField& Field = *FrontField;
+	const FIntPoint Local = GetCell(Location, Field.CellSize) - Field.Origin;
+
+	if (!Field.Contains(Local)) return false;
+
+	const int32 Index = Field.ToIndex(Local);
+	if (Field.Integration[Index] == MAX_flt) return false;
+
+	// The target's own cell has no direction, head straight for the target instead
+	if (Local == Field.TargetCell - Field.Origin)
+	{
+		const APawn* TargetPawn = Target.Get();
+		if (TargetPawn == nullptr) return false;
+
+		OutDirection = (TargetPawn->GetActorLocation() - Location).GetSafeNormal2D();
+		return true;
+	}
+
+	const FVector2f& Direction = Field.Directions[Index];
+	OutDirection = FVector(Direction.X, Direction.Y, 0.f);
+	return !OutDirection.IsNearlyZero();
+}
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UEnemyFlowFieldSubsystem::Deinitialize()
+{
+	// The worker writes into BackField, let it finish before the subsystem goes away
+	if (bBuildInFlight)
+	{
+		BuildTask.Wait();
+		bBuildInFlight = false;
+	}
+
+	Super::Deinitialize();
+}
+
+void UEnemyFlowFieldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	RPG_SCOPE_CYCLE_COUNTER(FlowField);
+
+	TryFinishBuild();
+
+	if (!CVarFlowFieldEnabled.GetValueOnGameThread())
+	{
+		FrontField.Reset();
+		Followers.Reset();
+		return;
+	}
+
+	UpdateWindow();
+	SampleCosts();
+	TryStartBuild(GetWorld()->GetTimeSeconds());
+	SteerFollowers();
+}
+
+TStatId UEnemyFlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyFlowFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Field Data
+ * ===================================================== */
+
+void UEnemyFlowFieldSubsystem::BuildField(FFlowField& Field)
+{
+	// Runs on a worker, shows up on that thread's track
+	RPG_SCOPE_CYCLE_COUNTER(FlowField);
+
+	const int32 NumCells = Field.Size * Field.Size;
+
+	Field.Integration.Init(MAX_flt, NumCells);
+	Field.Directions.Init(FVector2f::ZeroVector, NumCells);
+
+	const FIntPoint Target = Field.TargetCell - Field.Origin;
+	if (!Field.Contains(Target)) return;
+
+	// Diagonal steps may not cut past a blocked corner
+	auto CanStep = [&Field](const FIntPoint& From, const FIntPoint& Offset)
+	{
+		const FIntPoint To = From + Offset;
+		if (!Field.Contains(To) || Field.Costs[Field.ToIndex(To)] == BlockedCost) return false;
+
+		if (Offset.X != 0 && Offset.Y != 0)
+		{
+			return Field.Costs[Field.ToIndex(FIntPoint(From.X + Offset.X, From.Y))] != BlockedCost
+				&& Field.Costs[Field.ToIndex(FIntPoint(From.X, From.Y + Offset.Y))] != BlockedCost;
+		}
+		return true;
+	};
+
+	static const FIntPoint Offsets[] =
+	{
+		{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+		{ 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 }
+	};
+
+	using FOpenCell = TPair<float, int32>;
+	auto CheaperFirst = [](const FOpenCell& A, const FOpenCell& B) { return A.Key < B.Key; };
+
+	TArray<FOpenCell> Open;
+	Open.Reserve(NumCells);
+
+	// The player's own cell is seeded even if it didn't project, they may be mid-jump
+	const int32 TargetIndex = Field.ToIndex(Target);
+	Field.Integration[TargetIndex] = 0.f;
+	Open.HeapPush(FOpenCell(0.f, TargetIndex), CheaperFirst);
+
+	while (Open.Num() > 0)
+	{
+		FOpenCell Current;
+		Open.HeapPop(Current, CheaperFirst, EAllowShrinking::No);
+
+		if (Current.Key > Field.Integration[Current.Value]) continue;
+
+		const FIntPoint Cell(Current.Value % Field.Size, Current.Value / Field.Size);
+
+		for (const FIntPoint& Offset : Offsets)
+		{
+			if (!CanStep(Cell, Offset)) continue;
+
+			const int32 NeighbourIndex = Field.ToIndex(Cell + Offset);
+			const float StepCost = (Offset.X != 0 && Offset.Y != 0) ? UE_SQRT_2 : 1.f;
+			const float NewCost = Current.Key + StepCost * Field.Costs[NeighbourIndex];
+
+			if (NewCost < Field.Integration[NeighbourIndex])
+			{
+				Field.Integration[NeighbourIndex] = NewCost;
+				Open.HeapPush(FOpenCell(NewCost, NeighbourIndex), CheaperFirst);
+			}
+		}
+	}
+
+	// Each reachable cell points at its cheapest neighbour
+	for (int32 Index = 0; Index < NumCells; ++Index)
+	{
+		if (Index == TargetIndex || Field.Integration[Index] == MAX_flt) continue;
+
+		const FIntPoint Cell(Index % Field.Size, Index / Field.Size);
+		float BestCost = Field.Integration[Index];
+		FIntPoint BestOffset = FIntPoint::ZeroValue;
+
+		for (const FIntPoint& Offset : Offsets)
+		{
+			// The target cell is always a valid last step, even when it didn't project
+			const FIntPoint Neighbour = Cell + Offset;
+			if (Neighbour != Target && !CanStep(Cell, Offset)) continue;
+			if (!Field.Contains(Neighbour)) continue;
+
+			const float NeighbourCost = Field.Integration[Field.ToIndex(Neighbour)];
+			if (NeighbourCost < BestCost)
+			{
+				BestCost = NeighbourCost;
+				BestOffset = Offset;
+			}
+		}
+
+		Field.Directions[Index] = FVector2f(BestOffset.X, BestOffset.Y).GetSafeNormal();
+	}
+}
+
+FIntPoint UEnemyFlowFieldSubsystem::GetCell(const FVector& Location, double CellSize)
+{
+	return FIntPoint(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+/* =====================================================
+ * Incremental Rebuild
+ * ===================================================== */
+
+void UEnemyFlowFieldSubsystem::UpdateWindow()
+{
+	if (!Target.IsValid())
+	{
+		const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+		Target = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+		// A new target invalidates the field, followers drop back to pathing.
+		// A build still running for the old target is discarded when it finishes
+		FrontField.Reset();
+		bHasWindow = false;
+		LastBuildTargetCell = FIntPoint(MAX_int32, MAX_int32);
+		LastBuildOrigin = FIntPoint(MAX_int32, MAX_int32);
+		LastBuildTime = 0.0;
+	}
+
+	const APawn* TargetPawn = Target.Get();
+	if (TargetPawn == nullptr) return;
+
+	const int32 GridSize = FMath::Clamp(CVarFlowFieldGridSize.GetValueOnGameThread(), 8, 256);
+	const double CellSize = FMath::Max(25.f, CVarFlowFieldCellSize.GetValueOnGameThread());
+
+	// Changing the cell size changes every cell key, start the cache over
+	if (CellSize != WindowCellSize)
+	{
+		CostCache.Reset();
+		WindowCellSize = CellSize;
+		bHasWindow = false;
+	}
+
+	const FVector TargetLocation = TargetPawn->GetActorLocation();
+	const FIntPoint TargetCell = GetCell(TargetLocation, WindowCellSize);
+	const FIntPoint Centre = WindowOrigin + FIntPoint(WindowSize / 2);
+
+	// Only move the grid once the player has used up a quarter of it, so most rebuilds reuse every cost
+	const bool bNearEdge =
+		FMath::Abs(TargetCell.X - Centre.X) > WindowSize / 4 ||
+		FMath::Abs(TargetCell.Y - Centre.Y) > WindowSize / 4;
+
+	if (!bHasWindow || GridSize != WindowSize || bNearEdge)
+	{
+		WindowSize = GridSize;
+		WindowOrigin = TargetCell - FIntPoint(GridSize / 2);
+		WindowHeight = TargetLocation.Z;
+		WindowBand = FMath::FloorToInt32(WindowHeight / FMath::Max(1.f, CVarFlowFieldProjectionHeight.GetValueOnGameThread()));
+		SampleCursor = 0;
+		bHasWindow = true;
+
+		TrimCostCache();
+	}
+}
+
+void UEnemyFlowFieldSubsystem::SampleCosts()
+{
+	if (!bHasWindow) return;
+
+	const int32 NumCells = WindowSize * WindowSize;
+	if (SampleCursor >= NumCells) return;
+
+	const UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (NavSystem == nullptr) return;
+
+	const FVector Extent(WindowCellSize * 0.5, WindowCellSize * 0.5, CVarFlowFieldProjectionHeight.GetValueOnGameThread());
+	int32 SamplesLeft = CVarFlowFieldSamplesPerFrame.GetValueOnGameThread();
+
+	for (; SampleCursor < NumCells; ++SampleCursor)
+	{
+		const FIntPoint Cell = WindowOrigin + FIntPoint(SampleCursor % WindowSize, SampleCursor / WindowSize);
+		if (CostCache.Contains(GetCostKey(Cell))) continue;
+
+		if (SamplesLeft-- <= 0) break;
+
+		const FVector CellCentre((Cell.X + 0.5) * WindowCellSize, (Cell.Y + 0.5) * WindowCellSize, WindowHeight);
+
+		FNavLocation Projected;
+		const bool bWalkable = NavSystem->ProjectPointToNavigation(CellCentre, Projected, Extent);
+		CostCache.Add(GetCostKey(Cell), bWalkable ? WalkableCost : BlockedCost);
+	}
+}
+
+void UEnemyFlowFieldSubsystem::TrimCostCache()
+{
+	const FIntPoint WindowMax = WindowOrigin + FIntPoint(WindowSize);
+
+	for (auto It = CostCache.CreateIterator(); It; ++It)
+	{
+		const FIntVector& Key = It.Key();
+		const bool bInWindow =
+			Key.X >= WindowOrigin.X && Key.Y >= WindowOrigin.Y &&
+			Key.X < WindowMax.X && Key.Y < WindowMax.Y;
+
+		if (!bInWindow)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UEnemyFlowFieldSubsystem::TryStartBuild(double Now)
+{
+	if (bBuildInFlight || !bHasWindow || SampleCursor < WindowSize * WindowSize) return;
+
+	const APawn* TargetPawn = Target.Get();
+	if (TargetPawn == nullptr) return;
+
+	const FIntPoint TargetCell = GetCell(TargetPawn->GetActorLocation(), WindowCellSize);
+	if (TargetCell == LastBuildTargetCell && WindowOrigin == LastBuildOrigin) return;
+	if (Now - LastBuildTime < CVarFlowFieldRebuildInterval.GetValueOnGameThread()) return;
+
+	if (!BackField.IsValid())
+	{
+		BackField = MakeShared<FFlowField>();
+	}
+
+	FFlowField& Field = *BackField;
+	Field.Origin = WindowOrigin;
+	Field.Size = WindowSize;
+	Field.CellSize = WindowCellSize;
+	Field.TargetCell = TargetCell;
+	Field.Costs.SetNumUninitialized(WindowSize * WindowSize);
+
+	for (int32 Index = 0; Index < Field.Costs.Num(); ++Index)
+	{
+		const FIntPoint Cell = WindowOrigin + FIntPoint(Index % WindowSize, Index / WindowSize);
+		const uint8* Cost = CostCache.Find(GetCostKey(Cell));
+		Field.Costs[Index] = Cost ? *Cost : BlockedCost;
+	}
+
+	LastBuildTime = Now;
+	LastBuildTargetCell = TargetCell;
+	LastBuildOrigin = WindowOrigin;
+	BuildTarget = Target;
+	bBuildInFlight = true;
+
+	TSharedPtr<FFlowField> FieldToBuild = BackField;
+	BuildTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [FieldToBuild]()
+	{
+		BuildField(*FieldToBuild);
+	});
+}
+
+void UEnemyFlowFieldSubsystem::TryFinishBuild()
+{
+	if (!bBuildInFlight || !BuildTask.IsCompleted()) return;
+
+	bBuildInFlight = false;
+
+	// Built for a target or window that has since changed, steering by it would lead to the old cell
+	if (BuildTarget != Target ||
+		BackField->Origin != WindowOrigin ||
+		BackField->Size != WindowSize ||
+		BackField->CellSize != WindowCellSize)
+	{
+		return;
+	}
+
+	// The old front buffer becomes the next build's back buffer
+	Swap(FrontField, BackField);
+}
+
+/* =====================================================
+ * Steering
+ * ===================================================== */
+
+void UEnemyFlowFieldSubsystem::SteerFollowers()
+{
+	int32 NumKept = 0;
+	AvoidanceAgents.Reset();
+
+	for (int32 Index = 0; Index < Followers.Num(); ++Index)
+	{
+		AEnemy* Enemy = Followers[Index].Get();
+		if (Enemy == nullptr || Enemy->IsInPool()) continue;
+
+		// Attacking, patrolling or dead enemies leave the field on their own
+		if (Enemy->GetEnemyState() != EEnemyState::EES_Chasing) continue;
+
+		FVector Direction;
+		if (Enemy->GetCombatTarget() != Target.Get() || !SampleDirection(Enemy->GetActorLocation(), Direction))
+		{
+			Enemy->OnFlowFieldLost();
+			continue;
+		}
+
+		FEnemyAvoidance::FAgent& Agent = AvoidanceAgents.AddDefaulted_GetRef();
+		Agent.Enemy = Enemy;
+		Agent.Location = Enemy->GetActorLocation();
+		Agent.Radius = Enemy->GetCapsuleComponent()->GetScaledCapsuleRadius();
+		Agent.MaxSpeed = Enemy->GetCharacterMovement()->GetMaxSpeed();
+		Agent.DesiredVelocity = Direction * Agent.MaxSpeed;
+
+		Followers[NumKept++] = Enemy;
+	}
+
+	Followers.SetNum(NumKept, EAllowShrinking::No);
+
+	// Every follower converges on the same player, so bend them around each other before they move
+	if (const USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		FEnemyAvoidance::ComputeSteering(*SpatialHash, AvoidanceAgents, SteeringVelocities);
+	}
+	else
+	{
+		SteeringVelocities.Reset();
+		for (const FEnemyAvoidance::FAgent& Agent : AvoidanceAgents)
+		{
+			SteeringVelocities.Add(Agent.DesiredVelocity);
+		}
+	}
+
+	for (int32 Index = 0; Index < AvoidanceAgents.Num(); ++Index)
+	{
+		const FEnemyAvoidance::FAgent& Agent = AvoidanceAgents[Index];
+		Agent.Enemy->AddMovementInput(SteeringVelocities[Index] / FMath::Max(Agent.MaxSpeed, 1.f));
+	}
+
+	AvoidanceAgents.Reset();
+}
@@ -0,0 +1,329 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyPathSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavFilters/NavigationQueryFilter.h"
+
+// =======================
+// AI
+// =======================
+#include "AIController.h"
+
+// =======================
+// Enemy
+// =======================
+#include "Enemy/Enemy.h"
+
+/* =====================================================
+ * Console Variables
+ * ===================================================== */
+
+static TAutoConsoleVariable<int32> CVarEnemyPathMaxQueriesPerFrame(
+	TEXT("rpg.EnemyPath.MaxQueriesPerFrame"),
+	8,
+	TEXT("Async navmesh queries the path scheduler may start each frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyPathShareRadius(
+	TEXT("rpg.EnemyPath.ShareRadius"),
+	300.f,
+	TEXT("Enemies starting within this distance of another's path start reuse its path to the same goal."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyPathCacheLifetime(
+	TEXT("rpg.EnemyPath.CacheLifetime"),
+	0.5f,
+	TEXT("Seconds a path to a pawn stays in the shared cache."),
+	ECVF_Default);
+
+// Same tether AAIController::MoveTo uses, goal actors moving further than this trigger a repath
+static constexpr float GoalTetherDistance = 100.f;
+
+/* =====================================================
+ * Requests
+ * ===================================================== */
+
+void UEnemyPathSubsystem::RequestMove(AEnemy* Enemy, AActor* Goal, float AcceptanceRadius)
+{
+	if (Enemy == nullptr || Goal == nullptr) return;
+
+	// Superseding is lazy: older requests for this enemy are skipped when they come up
+	FPathRequest& Request = QueuedRequests.AddDefaulted_GetRef();
+	Request.Enemy = Enemy;
+	Request.Goal = Goal;
+	Request.AcceptanceRadius = AcceptanceRadius;
+	Request.Serial = NextSerial++;
+
+	LatestSerials.Add(Enemy, Request.Serial);
+}
+
+void UEnemyPathSubsystem::CancelRequests(AEnemy* Enemy)
+{
+	LatestSerials.Remove(Enemy);
+}
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UEnemyPathSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	PruneCache(Now);
+
+	if (QueuedRequests.Num() == 0) return;
+
+	int32 QueriesLeft = CVarEnemyPathMaxQueriesPerFrame.GetValueOnGameThread();
+	int32 NumKept = 0;
+
+	for (int32 Index = 0; Index < QueuedRequests.Num(); ++Index)
+	{
+		const FPathRequest Request = QueuedRequests[Index];
+		const AEnemy* Enemy = Request.Enemy.Get();
+		const AActor* Goal = Request.Goal.Get();
+
+		if (Enemy == nullptr || Goal == nullptr || !IsCurrent(Request)) continue;
+
+		if (FNavPathSharedPtr CachedPath = FindCachedPath(Goal, Enemy->GetNavAgentLocation(), Now))
+		{
+			LatestSerials.Remove(Request.Enemy.Get());
+			ApplyPath(Request, CachedPath, true);
+			continue;
+		}
+
+		// Sharing a query in flight is free, so it doesn't count against the budget
+		if (JoinInFlightQuery(Request)) continue;
+
+		if (QueriesLeft > 0)
+		{
+			--QueriesLeft;
+			if (IssueQuery(Request)) continue;
+
+			LatestSerials.Remove(Request.Enemy.Get());
+			continue;
+		}
+
+		// Out of budget, keep the request in order for next frame
+		QueuedRequests[NumKept++] = Request;
+	}
+
+	QueuedRequests.SetNum(NumKept, EAllowShrinking::No);
+}
+
+TStatId UEnemyPathSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPathSubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyPathSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Queue
+ * ===================================================== */
+
+bool UEnemyPathSubsystem::IsCurrent(const FPathRequest& Request) const
+{
+	const uint32* LatestSerial = LatestSerials.Find(Request.Enemy.Get());
+	return LatestSerial && *LatestSerial == Request.Serial;
+}
+
+bool UEnemyPathSubsystem::IssueQuery(const FPathRequest& Request)
+{
+	AEnemy* Enemy = Request.Enemy.Get();
+	AActor* Goal = Request.Goal.Get();
+	const AAIController* Controller = Enemy ? Cast<AAIController>(Enemy->GetController()) : nullptr;
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (Controller == nullptr || Goal == nullptr || NavSystem == nullptr) return false;
+
+	const FNavAgentProperties& AgentProperties = Controller->GetNavAgentPropertiesRef();
+	const FVector Start = Controller->GetNavAgentLocation();
+
+	const ANavigationData* NavData = NavSystem->GetNavDataForProps(AgentProperties, Start);
+	if (NavData == nullptr) return false;
+
+	FPathFindingQuery Query(
+		*Controller,
+		*NavData,
+		Start,
+		Goal->GetActorLocation(),
+		UNavigationQueryFilter::GetQueryFilter(*NavData, Controller, nullptr));
+
+	Query.SetAllowPartialPaths(true);
+
+	const uint32 QueryId = NavSystem->FindPathAsync(
+		AgentProperties,
+		Query,
+		FNavPathQueryDelegate::CreateUObject(this, &UEnemyPathSubsystem::OnPathFound),
+		EPathFindingMode::Regular);
+
+	if (QueryId == INVALID_NAVQUERYID) return false;
+
+	FPathQuery& PathQuery = InFlightQueries.Add(QueryId);
+	PathQuery.Goal = Goal;
+	PathQuery.Start = Start;
+	PathQuery.Requests.Add(Request);
+
+	return true;
+}
+
+bool UEnemyPathSubsystem::JoinInFlightQuery(const FPathRequest& Request)
+{
+	const FVector Location = Request.Enemy->GetNavAgentLocation();
+	const double ShareRadiusSquared = FMath::Square(CVarEnemyPathShareRadius.GetValueOnGameThread());
+
+	for (TPair<uint32, FPathQuery>& InFlight : InFlightQueries)
+	{
+		FPathQuery& PathQuery = InFlight.Value;
+
+		if (PathQuery.Goal == Request.Goal &&
+			FVector::DistSquared(PathQuery.Start, Location) <= ShareRadiusSquared)
+		{
+			PathQuery.Requests.Add(Request);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UEnemyPathSubsystem::OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	FPathQuery PathQuery;
+	if (!InFlightQueries.RemoveAndCopyValue(QueryId, PathQuery)) return;
+
+	const bool bFound = Result == ENavigationQueryResult::Success && Path.IsValid() && Path->IsValid();
+
+	if (bFound && Cast<APawn>(PathQuery.Goal.Get()))
+	{
+		// Only pawns are worth caching, they are what whole packs chase at once
+		AddCachedPath(PathQuery.Goal.Get(), Path, GetWorld()->GetTimeSeconds());
+	}
+
+	for (int32 Index = 0; Index < PathQuery.Requests.Num(); ++Index)
+	{
+		const FPathRequest& Request = PathQuery.Requests[Index];
+
+		// Superseded or cancelled while the query ran
+		if (!IsCurrent(Request)) continue;
+
+		LatestSerials.Remove(Request.Enemy.Get());
+
+		if (bFound)
+		{
+			// The issuer takes the path itself, everyone who joined gets a copy
+			ApplyPath(Request, Path, Index > 0);
+		}
+	}
+}
+
+void UEnemyPathSubsystem::ApplyPath(const FPathRequest& Request, const FNavPathSharedPtr& Path, bool bShared)
+{
+	AEnemy* Enemy = Request.Enemy.Get();
+	AActor* Goal = Request.Goal.Get();
+	AAIController* Controller = Enemy ? Cast<AAIController>(Enemy->GetController()) : nullptr;
+
+	if (Controller == nullptr || Goal == nullptr || !Path.IsValid()) return;
+
+	FNavPathSharedPtr MovePath = Path;
+
+	if (bShared)
+	{
+		// Same route, but starting where this enemy actually stands
+		const FVector Start = Controller->GetNavAgentLocation();
+
+		MovePath = MakeShared<FNavigationPath, ESPMode::ThreadSafe>();
+		MovePath->GetPathPoints() = Path->GetPathPoints();
+		MovePath->GetPathPoints()[0].Location = Start;
+		MovePath->SetNavigationDataUsed(Path->GetNavigationDataUsed());
+
+		FPathFindingQueryData QueryData = Path->GetQueryData();
+		QueryData.StartLocation = Start;
+		MovePath->SetQueryData(QueryData);
+		MovePath->MarkReady();
+	}
+
+	// Follow the goal like AAIController::MoveTo does, repathing when it moves away
+	MovePath->SetGoalActorObservation(*Goal, GoalTetherDistance);
+	MovePath->EnableRecalculationOnInvalidation(true);
+
+	FAIMoveRequest MoveRequest;
+	MoveRequest.SetGoalActor(Goal);
+	MoveRequest.SetAcceptanceRadius(Request.AcceptanceRadius);
+
+	Controller->RequestMove(MoveRequest, MovePath);
+}
+
+/* =====================================================
+ * Shared Path Cache
+ * ===================================================== */
+
+FNavPathSharedPtr UEnemyPathSubsystem::FindCachedPath(const AActor* Goal, const FVector& Location, double Now) const
+{
+	const TArray<FCachedPath, TInlineAllocator<4>>* CachedPaths = PathCache.Find(Goal);
+	if (CachedPaths == nullptr) return nullptr;
+
+	const double Lifetime = CVarEnemyPathCacheLifetime.GetValueOnGameThread();
+	const double ShareRadiusSquared = FMath::Square(CVarEnemyPathShareRadius.GetValueOnGameThread());
+
+	for (const FCachedPath& Cached : *CachedPaths)
+	{
+		if (Now - Cached.Time <= Lifetime &&
+			FVector::DistSquared(Cached.Start, Location) <= ShareRadiusSquared)
+		{
+			return Cached.Path;
+		}
+	}
+
+	return nullptr;
+}
+
+void UEnemyPathSubsystem::AddCachedPath(const AActor* Goal, const FNavPathSharedPtr& Path, double Now)
+{
+	TArray<FCachedPath, TInlineAllocator<4>>& CachedPaths = PathCache.FindOrAdd(Goal);
+
+	// Keep a private copy, the enemy following the original may repath it in place
+	FCachedPath& Cached = CachedPaths.AddDefaulted_GetRef();
+	Cached.Path = MakeShared<FNavigationPath, ESPMode::ThreadSafe>();
+	Cached.Path->GetPathPoints() = Path->GetPathPoints();
+	Cached.Path->SetNavigationDataUsed(Path->GetNavigationDataUsed());
+	Cached.Path->SetQueryData(Path->GetQueryData());
+	Cached.Path->MarkReady();
+	Cached.Start = Path->GetPathPoints()[0].Location;
+	Cached.Time = Now;
+
+	// A handful of starting areas per goal is plenty, drop the oldest
+	if (CachedPaths.Num() > 4)
+	{
+		CachedPaths.RemoveAt(0, 1, EAllowShrinking::No);
+	}
+}
+
+void UEnemyPathSubsystem::PruneCache(double Now)
+{
+	const double Lifetime = CVarEnemyPathCacheLifetime.GetValueOnGameThread();
+	if (Now - LastPruneTime < Lifetime) return;
+	LastPruneTime = Now;
+
+	for (auto It = PathCache.CreateIterator(); It; ++It)
+	{
+		It.Value().RemoveAll([Now, Lifetime](const FCachedPath& Cached) { return Now - Cached.Time > Lifetime; });
+
+		if (It.Value().Num() == 0)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
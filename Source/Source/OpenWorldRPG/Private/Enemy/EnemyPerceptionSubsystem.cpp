@@ -0,0 +1,328 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyPerceptionSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "Engine/World.h"
+#include "CollisionQueryParams.h"
+#include "OpenWorldRPG.h"
+
+// =======================
+// AI
+// =======================
+#include "Perception/PawnSensingComponent.h"
+
+// =======================
+// Enemy / Spatial
+// =======================
+#include "Enemy/Enemy.h"
+#include "Spatial/SpatialHashSubsystem.h"
+
+// Cached sight results older than this are forgotten
+static constexpr double SightCacheLifetime = 5.0;
+
+// Pawns look from their eyes, anything else from its origin
+static FVector GetSightLocation(const AActor* Actor)
+{
+	const APawn* Pawn = Cast<APawn>(Actor);
+	return Pawn ? Pawn->GetPawnViewLocation() : Actor->GetActorLocation();
+}
+
+/* =====================================================
+ * Registration
+ * ===================================================== */
+
+void UEnemyPerceptionSubsystem::RegisterObserver(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || FindObserver(Enemy)) return;
+
+	FPerceptionObserver& Observer = Observers.AddDefaulted_GetRef();
+	Observer.Enemy = Enemy;
+	ObserverIndices.Add(Enemy, Observers.Num() - 1);
+
+	// Spread first looks over one interval so a level full of enemies doesn't sense in lockstep
+	const UPawnSensingComponent* PawnSensing = Enemy->GetPawnSensing();
+	const float Interval = PawnSensing ? PawnSensing->SensingInterval : 0.5f;
+	Observer.NextSenseTime = GetWorld()->GetTimeSeconds() + FMath::FRandRange(0.f, Interval);
+}
+
+void UEnemyPerceptionSubsystem::UnregisterObserver(AEnemy* Enemy)
+{
+	if (FPerceptionObserver* Observer = FindObserver(Enemy))
+	{
+		// Compacted next tick, so indices stay valid for the rest of this frame
+		Observer->Enemy = nullptr;
+		Observer->VisibleTargets.Reset();
+	}
+
+	ObserverIndices.Remove(Enemy);
+}
+
+void UEnemyPerceptionSubsystem::ResetObserver(AEnemy* Enemy)
+{
+	if (FPerceptionObserver* Observer = FindObserver(Enemy))
+	{
+		Observer->VisibleTargets.Reset();
+	}
+}
+
+/* =====================================================
+ * Line of Sight Queries
+ * ===================================================== */
+
+void UEnemyPerceptionSubsystem::RequestLineOfSight(AActor* Observer, AActor* Target)
+{
+	if (Observer == nullptr || Target == nullptr) return;
+
+	FSightTrace& Trace = QueuedTraces.FindOrAdd(FSightPairKey(Observer, Target));
+	Trace.Observer = Observer;
+	Trace.Target = Target;
+}
+
+bool UEnemyPerceptionSubsystem::GetCachedLineOfSight(
+	const AActor* Observer,
+	const AActor* Target,
+	bool& bOutVisible,
+	double& OutResultTime) const
+{
+	const FCachedSight* Cached = SightCache.Find(FSightPairKey(Observer, Target));
+	if (Cached == nullptr) return false;
+
+	bOutVisible = Cached->bVisible;
+	OutResultTime = Cached->ResultTime;
+	return true;
+}
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UEnemyPerceptionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	const int32 NumRemoved = Observers.RemoveAll(
+		[](const FPerceptionObserver& Observer) { return !Observer.Enemy.IsValid(); });
+
+	if (NumRemoved > 0)
+	{
+		RebuildObserverIndices();
+	}
+
+	// Last frame's traces are read back before this frame's batch goes out
+	CollectSightTraces(Now);
+	ApplySightResults();
+
+	GatherSightRequests(Now);
+	IssueSightTraces();
+
+	PruneSightCache(Now);
+}
+
+TStatId UEnemyPerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyPerceptionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Observers
+ * ===================================================== */
+
+UEnemyPerceptionSubsystem::FPerceptionObserver* UEnemyPerceptionSubsystem::FindObserver(const AEnemy* Enemy)
+{
+	const int32* ObserverIndex = ObserverIndices.Find(Enemy);
+	return ObserverIndex ? &Observers[*ObserverIndex] : nullptr;
+}
+
+void UEnemyPerceptionSubsystem::RebuildObserverIndices()
+{
+	ObserverIndices.Reset();
+
+	for (int32 ObserverIndex = 0; ObserverIndex < Observers.Num(); ++ObserverIndex)
+	{
+		ObserverIndices.Add(Observers[ObserverIndex].Enemy.Get(), ObserverIndex);
+	}
+}
+
+void UEnemyPerceptionSubsystem::GatherSightRequests(double Now)
+{
+	USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>();
+	if (SpatialHash == nullptr) return;
+
+	TArray<AActor*, TInlineAllocator<4>> Candidates;
+
+	for (FPerceptionObserver& Observer : Observers)
+	{
+		AEnemy* Enemy = Observer.Enemy.Get();
+		const UPawnSensingComponent* PawnSensing = Enemy ? Enemy->GetPawnSensing() : nullptr;
+
+		if (PawnSensing == nullptr || Now < Observer.NextSenseTime) continue;
+
+		// Dormant and dead enemies keep nothing in view
+		if (Enemy->GetAILOD() == EEnemyAILOD::EAL_Dormant ||
+			Enemy->GetEnemyState() == EEnemyState::EES_Dead)
+		{
+			Observer.VisibleTargets.Reset();
+			continue;
+		}
+
+		// PawnSensing's interval is already scaled by the enemy's LOD
+		Observer.NextSenseTime = Now + PawnSensing->SensingInterval;
+
+		const FVector Forward = Enemy->GetActorForwardVector();
+		const float PeripheralCosine = PawnSensing->GetPeripheralVisionCosine();
+
+		Candidates.Reset();
+		SpatialHash->QueryRadius(
+			Enemy->GetActorLocation(),
+			PawnSensing->SightRadius,
+			ESpatialCategory::Player,
+			Candidates);
+
+		// Targets that left range or cone are lost without needing a trace
+		Observer.VisibleTargets.RemoveAll([&Candidates](const TWeakObjectPtr<APawn>& Target)
+		{
+			return !Target.IsValid() || !Candidates.Contains(Target.Get());
+		});
+
+		for (AActor* Candidate : Candidates)
+		{
+			APawn* CandidatePawn = Cast<APawn>(Candidate);
+			if (CandidatePawn == nullptr) continue;
+
+			const FVector ToCandidate =
+				(CandidatePawn->GetActorLocation() - Enemy->GetActorLocation()).GetSafeNormal();
+
+			if (FVector::DotProduct(Forward, ToCandidate) < PeripheralCosine)
+			{
+				Observer.VisibleTargets.Remove(CandidatePawn);
+				continue;
+			}
+
+			RequestLineOfSight(Enemy, CandidatePawn);
+		}
+	}
+}
+
+void UEnemyPerceptionSubsystem::ApplySightResults()
+{
+	for (const FSightResult& Result : CompletedResults)
+	{
+		const int32* ObserverIndex = ObserverIndices.Find(Cast<AEnemy>(Result.Observer.Get()));
+		APawn* Target = Cast<APawn>(Result.Target.Get());
+
+		if (ObserverIndex == nullptr || Target == nullptr) continue;
+
+		FPerceptionObserver& Observer = Observers[*ObserverIndex];
+		AEnemy* Enemy = Observer.Enemy.Get();
+		if (Enemy == nullptr) continue;
+
+		const bool bWasVisible = Observer.VisibleTargets.Contains(Target);
+
+		if (Result.bVisible && !bWasVisible)
+		{
+			Observer.VisibleTargets.Add(Target);
+			Enemy->PawnSeen(Target);
+		}
+		else if (Result.bVisible && Enemy->GetEnemyState() == EEnemyState::EES_Patrolling)
+		{
+			// Seen while busy and still in view after giving up the chase, so pick it up again
+			Enemy->PawnSeen(Target);
+		}
+		else if (!Result.bVisible && bWasVisible)
+		{
+			Observer.VisibleTargets.Remove(Target);
+		}
+	}
+}
+
+/* =====================================================
+ * Async Trace Batch
+ * ===================================================== */
+
+void UEnemyPerceptionSubsystem::IssueSightTraces()
+{
+	UWorld* World = GetWorld();
+
+	// Only level geometry blocks sight; enemy meshes are WorldDynamic and would hide a fight from a crowd
+	const FCollisionObjectQueryParams BlockerParams(ECollisionChannel::ECC_WorldStatic);
+
+	for (TPair<FSightPairKey, FSightTrace>& Queued : QueuedTraces)
+	{
+		const AActor* Observer = Queued.Value.Observer.Get();
+		const AActor* Target = Queued.Value.Target.Get();
+		if (Observer == nullptr || Target == nullptr) continue;
+
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(EnemySight), true, Observer);
+		Params.AddIgnoredActor(Target);
+
+		FSightTrace& Trace = InFlightTraces.Add_GetRef(Queued.Value);
+		Trace.Handle = World->AsyncLineTraceByObjectType(
+			EAsyncTraceType::Test,
+			GetSightLocation(Observer),
+			GetSightLocation(Target),
+			BlockerParams,
+			Params);
+
+		RPG_COUNTER_ADD(TracesIssued, 1);
+	}
+
+	QueuedTraces.Reset();
+}
+
+void UEnemyPerceptionSubsystem::CollectSightTraces(double Now)
+{
+	UWorld* World = GetWorld();
+	CompletedResults.Reset();
+
+	for (int32 TraceIndex = InFlightTraces.Num() - 1; TraceIndex >= 0; --TraceIndex)
+	{
+		const FSightTrace& Trace = InFlightTraces[TraceIndex];
+
+		FTraceDatum TraceData;
+		if (World->QueryTraceData(Trace.Handle, TraceData))
+		{
+			// Test traces report a single blocking hit when something is in the way
+			const bool bVisible = TraceData.OutHits.Num() == 0;
+
+			FCachedSight& Cached = SightCache.FindOrAdd(FSightPairKey(Trace.Observer.Get(), Trace.Target.Get()));
+			Cached.bVisible = bVisible;
+			Cached.ResultTime = Now;
+
+			FSightResult& Result = CompletedResults.AddDefaulted_GetRef();
+			Result.Observer = Trace.Observer;
+			Result.Target = Trace.Target;
+			Result.bVisible = bVisible;
+		}
+		else if (World->IsTraceHandleValid(Trace.Handle, false))
+		{
+			// Issued too late in the frame to run yet, read it back next frame
+			continue;
+		}
+
+		InFlightTraces.RemoveAtSwap(TraceIndex);
+	}
+}
+
+void UEnemyPerceptionSubsystem::PruneSightCache(double Now)
+{
+	if (Now - LastPruneTime < SightCacheLifetime) return;
+	LastPruneTime = Now;
+
+	for (auto It = SightCache.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().ResultTime > SightCacheLifetime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyPoolSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "Engine/World.h"
+
+// =======================
+// Enemy / Pooling
+// =======================
+#include "Enemy/Enemy.h"
+#include "Pooling/PoolSettings.h"
+
+/* =====================================================
+ * Acquire / Release
+ * ===================================================== */
+
+AEnemy* UEnemyPoolSubsystem::AcquireEnemy(
+	TSubclassOf<AEnemy> EnemyClass,
+	const FTransform& SpawnTransform,
+	TFunctionRef<void(AEnemy&)> Prepare)
+{
+	if (EnemyClass == nullptr) return nullptr;
+
+	if (TArray<TWeakObjectPtr<AEnemy>>* Free = FreeEnemies.Find(EnemyClass.Get()))
+	{
+		while (Free->Num() > 0)
+		{
+			AEnemy* Enemy = Free->Pop(EAllowShrinking::No).Get();
+			if (Enemy == nullptr) continue;
+
+			Prepare(*Enemy);
+			Enemy->ActivateFromPool(SpawnTransform);
+			return Enemy;
+		}
+	}
+
+	return SpawnEnemy(EnemyClass, SpawnTransform, Prepare);
+}
+
+AEnemy* UEnemyPoolSubsystem::AcquireEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& SpawnTransform)
+{
+	return AcquireEnemy(EnemyClass, SpawnTransform, [](AEnemy&) {});
+}
+
+void UEnemyPoolSubsystem::ReleaseEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || Enemy->IsInPool()) return;
+
+	TArray<TWeakObjectPtr<AEnemy>>& Free = FreeEnemies.FindOrAdd(Enemy->GetClass());
+
+	if (Free.Num() >= GetDefault<UPoolSettings>()->MaxPooledEnemiesPerClass)
+	{
+		Enemy->Destroy();
+		return;
+	}
+
+	Enemy->DeactivateForPool();
+	Free.Add(Enemy);
+}
+
+void UEnemyPoolSubsystem::WarmUp(TSubclassOf<AEnemy> EnemyClass, int32 Count)
+{
+	if (EnemyClass == nullptr) return;
+
+	// Parked out of sight until acquired
+	const FTransform ParkingTransform(FVector(0.f, 0.f, -100000.f));
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		if (AEnemy* Enemy = SpawnEnemy(EnemyClass, ParkingTransform, [](AEnemy&) {}))
+		{
+			ReleaseEnemy(Enemy);
+		}
+	}
+}
+
+int32 UEnemyPoolSubsystem::GetNumPooled(TSubclassOf<AEnemy> EnemyClass) const
+{
+	const TArray<TWeakObjectPtr<AEnemy>>* Free = FreeEnemies.Find(EnemyClass.Get());
+	return Free ? Free->Num() : 0;
+}
+
+/* =====================================================
+ * <UWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UEnemyPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (const TPair<TSoftClassPtr<AEnemy>, int32>& WarmUpCount : GetDefault<UPoolSettings>()->EnemyWarmUpCounts)
+	{
+		WarmUp(WarmUpCount.Key.LoadSynchronous(), WarmUpCount.Value);
+	}
+}
+
+bool UEnemyPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Spawning
+ * ===================================================== */
+
+AEnemy* UEnemyPoolSubsystem::SpawnEnemy(
+	TSubclassOf<AEnemy> EnemyClass,
+	const FTransform& SpawnTransform,
+	TFunctionRef<void(AEnemy&)> Prepare)
+{
+	AEnemy* Enemy = GetWorld()->SpawnActorDeferred<AEnemy>(
+		EnemyClass,
+		SpawnTransform,
+		nullptr,
+		nullptr,
+		ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+
+	if (Enemy == nullptr) return nullptr;
+
+	// The controller has to exist by BeginPlay, which is where the enemy caches it.
+	// It then stays possessed for every reuse
+	Enemy->AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+
+	Prepare(*Enemy);
+	Enemy->FinishSpawning(SpawnTransform);
+
+	return Enemy;
+}
@@ -0,0 +1,308 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyStateStore.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "Math/VectorRegister.h"
+#include "HAL/IConsoleManager.h"
+#include "GameFramework/Actor.h"
+#include "OpenWorldRPG.h"
+
+// =======================
+// Enemy
+// =======================
+#include "Enemy/Enemy.h"
+
+/* =====================================================
+ * Slots
+ * ===================================================== */
+
+int32 FEnemyStateStore::AddEnemy(AEnemy* Enemy)
+{
+	int32 Slot = INDEX_NONE;
+
+	if (FreeSlots.Num() > 0)
+	{
+		Slot = FreeSlots.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Slot = Enemies.AddDefaulted();
+		PosX.AddZeroed();
+		PosY.AddZeroed();
+		PosZ.AddZeroed();
+		TargetX.AddZeroed();
+		TargetY.AddZeroed();
+		TargetZ.AddZeroed();
+		AttackRadiusSq.AddZeroed();
+		CombatRadiusSq.AddZeroed();
+		HasTarget.AddZeroed();
+		CombatIndex.Add(INDEX_NONE);
+		RangeClass.Add(static_cast<uint8>(EEnemyRangeClass::NoTarget));
+		PreviousRangeClass.Add(static_cast<uint8>(EEnemyRangeClass::NoTarget));
+	}
+
+	Enemies[Slot] = Enemy;
+	ClearTarget(Slot);
+	RangeClass[Slot] = static_cast<uint8>(EEnemyRangeClass::NoTarget);
+	PreviousRangeClass[Slot] = static_cast<uint8>(EEnemyRangeClass::NoTarget);
+
+	return Slot;
+}
+
+void FEnemyStateStore::RemoveEnemy(int32 Slot)
+{
+	if (!Enemies.IsValidIndex(Slot)) return;
+
+	SetInCombat(Slot, false);
+	Enemies[Slot] = nullptr;
+	ClearTarget(Slot);
+	FreeSlots.Add(Slot);
+}
+
+/* =====================================================
+ * Mirroring
+ * ===================================================== */
+
+void FEnemyStateStore::SyncSlot(
+	int32 Slot,
+	const FVector& Location,
+	const AActor* Target,
+	double AttackRadius,
+	double CombatRadius)
+{
+	if (Target == nullptr)
+	{
+		ClearTarget(Slot);
+		return;
+	}
+
+	const FVector TargetLocation = Target->GetActorLocation();
+
+	PosX[Slot] = static_cast<float>(Location.X);
+	PosY[Slot] = static_cast<float>(Location.Y);
+	PosZ[Slot] = static_cast<float>(Location.Z);
+	TargetX[Slot] = static_cast<float>(TargetLocation.X);
+	TargetY[Slot] = static_cast<float>(TargetLocation.Y);
+	TargetZ[Slot] = static_cast<float>(TargetLocation.Z);
+	AttackRadiusSq[Slot] = static_cast<float>(FMath::Square(AttackRadius));
+	CombatRadiusSq[Slot] = static_cast<float>(FMath::Square(CombatRadius));
+	HasTarget[Slot] = 1;
+}
+
+void FEnemyStateStore::ClearTarget(int32 Slot)
+{
+	// Negative radii can never contain a target, so the kernel needs no branch
+	AttackRadiusSq[Slot] = -1.f;
+	CombatRadiusSq[Slot] = -1.f;
+	HasTarget[Slot] = 0;
+}
+
+void FEnemyStateStore::SetInCombat(int32 Slot, bool bInCombat)
+{
+	if (!CombatIndex.IsValidIndex(Slot)) return;
+
+	const int32 Index = CombatIndex[Slot];
+	if (bInCombat == (Index != INDEX_NONE)) return;
+
+	if (bInCombat)
+	{
+		CombatIndex[Slot] = CombatSlots.Add(Slot);
+		return;
+	}
+
+	// Swap-remove, then repoint whichever slot moved into the hole
+	CombatSlots.RemoveAtSwap(Index, EAllowShrinking::No);
+	if (CombatSlots.IsValidIndex(Index))
+	{
+		CombatIndex[CombatSlots[Index]] = Index;
+	}
+
+	CombatIndex[Slot] = INDEX_NONE;
+	ClearTarget(Slot);
+}
+
+/* =====================================================
+ * Classification
+ * ===================================================== */
+
+void FEnemyStateStore::Classify()
+{
+	Swap(RangeClass, PreviousRangeClass);
+
+	ClassifyRangesSIMD(MakeKernelArgs());
+
+	RangeChanges.Reset();
+	for (int32 Slot = 0; Slot < RangeClass.Num(); ++Slot)
+	{
+		if (RangeClass[Slot] != PreviousRangeClass[Slot] && Enemies[Slot].IsValid())
+		{
+			RangeChanges.Add(Slot);
+		}
+	}
+}
+
+FEnemyStateStore::FRangeKernelArgs FEnemyStateStore::MakeKernelArgs()
+{
+	FRangeKernelArgs Args;
+	Args.PosX = PosX.GetData();
+	Args.PosY = PosY.GetData();
+	Args.PosZ = PosZ.GetData();
+	Args.TargetX = TargetX.GetData();
+	Args.TargetY = TargetY.GetData();
+	Args.TargetZ = TargetZ.GetData();
+	Args.AttackRadiusSq = AttackRadiusSq.GetData();
+	Args.CombatRadiusSq = CombatRadiusSq.GetData();
+	Args.HasTarget = HasTarget.GetData();
+	Args.OutRangeClass = RangeClass.GetData();
+	Args.Num = RangeClass.Num();
+	return Args;
+}
+
+/* =====================================================
+ * Range Kernel
+ * ===================================================== */
+
+static FORCEINLINE uint8 PickRangeClass(bool bHasTarget, bool bInsideAttack, bool bInsideCombat)
+{
+	if (!bHasTarget) return static_cast<uint8>(EEnemyRangeClass::NoTarget);
+	if (bInsideAttack) return static_cast<uint8>(EEnemyRangeClass::InsideAttack);
+	if (bInsideCombat) return static_cast<uint8>(EEnemyRangeClass::InsideCombat);
+	return static_cast<uint8>(EEnemyRangeClass::OutsideCombat);
+}
+
+void FEnemyStateStore::ClassifyRangesSIMD(const FRangeKernelArgs& Args)
+{
+	const int32 NumVectorized = Args.Num & ~3;
+	int32 Index = 0;
+
+	for (; Index < NumVectorized; Index += 4)
+	{
+		const VectorRegister4Float DeltaX = VectorSubtract(VectorLoad(Args.TargetX + Index), VectorLoad(Args.PosX + Index));
+		const VectorRegister4Float DeltaY = VectorSubtract(VectorLoad(Args.TargetY + Index), VectorLoad(Args.PosY + Index));
+		const VectorRegister4Float DeltaZ = VectorSubtract(VectorLoad(Args.TargetZ + Index), VectorLoad(Args.PosZ + Index));
+
+		VectorRegister4Float DistSquared = VectorMultiply(DeltaX, DeltaX);
+		DistSquared = VectorMultiplyAdd(DeltaY, DeltaY, DistSquared);
+		DistSquared = VectorMultiplyAdd(DeltaZ, DeltaZ, DistSquared);
+
+		const int32 InsideAttackBits = VectorMaskBits(VectorCompareLE(DistSquared, VectorLoad(Args.AttackRadiusSq + Index)));
+		const int32 InsideCombatBits = VectorMaskBits(VectorCompareLE(DistSquared, VectorLoad(Args.CombatRadiusSq + Index)));
+
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			Args.OutRangeClass[Index + Lane] = PickRangeClass(
+				Args.HasTarget[Index + Lane] != 0,
+				(InsideAttackBits >> Lane) & 1,
+				(InsideCombatBits >> Lane) & 1);
+		}
+	}
+
+	// Leftover slots that don't fill a whole register
+	FRangeKernelArgs Tail = Args;
+	Tail.PosX += Index;
+	Tail.PosY += Index;
+	Tail.PosZ += Index;
+	Tail.TargetX += Index;
+	Tail.TargetY += Index;
+	Tail.TargetZ += Index;
+	Tail.AttackRadiusSq += Index;
+	Tail.CombatRadiusSq += Index;
+	Tail.HasTarget += Index;
+	Tail.OutRangeClass += Index;
+	Tail.Num = Args.Num - Index;
+	ClassifyRangesScalar(Tail);
+}
+
+void FEnemyStateStore::ClassifyRangesScalar(const FRangeKernelArgs& Args)
+{
+	for (int32 Index = 0; Index < Args.Num; ++Index)
+	{
+		const float DeltaX = Args.TargetX[Index] - Args.PosX[Index];
+		const float DeltaY = Args.TargetY[Index] - Args.PosY[Index];
+		const float DeltaZ = Args.TargetZ[Index] - Args.PosZ[Index];
+		const float DistSquared = DeltaX * DeltaX + DeltaY * DeltaY + DeltaZ * DeltaZ;
+
+		Args.OutRangeClass[Index] = PickRangeClass(
+			Args.HasTarget[Index] != 0,
+			DistSquared <= Args.AttackRadiusSq[Index],
+			DistSquared <= Args.CombatRadiusSq[Index]);
+	}
+}
+
+/* =====================================================
+ * Benchmark
+ * ===================================================== */
+
+// Times both range kernels on synthetic crowds: rpg.Bench.EnemyRangeKernel [Iterations]
+static FAutoConsoleCommand BenchEnemyRangeKernelCommand(
+	TEXT("rpg.Bench.EnemyRangeKernel"),
+	TEXT("Times the SIMD and scalar enemy range kernels at 1k, 10k and 50k enemies."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& CommandArgs)
+	{
+		const int32 Iterations = CommandArgs.Num() > 0 ? FMath::Max(1, FCString::Atoi(*CommandArgs[0])) : 200;
+		const int32 EnemyCounts[] = { 1000, 10000, 50000 };
+
+		FRandomStream Random(1337);
+
+		for (const int32 NumEnemies : EnemyCounts)
+		{
+			TArray<float> PosX, PosY, PosZ, TargetX, TargetY, TargetZ, AttackRadiusSq, CombatRadiusSq;
+			TArray<uint8> HasTarget, SIMDOut, ScalarOut;
+
+			for (TArray<float>* Column : { &PosX, &PosY, &PosZ, &TargetX, &TargetY, &TargetZ })
+			{
+				Column->SetNumUninitialized(NumEnemies);
+				for (float& Value : *Column)
+				{
+					Value = Random.FRandRange(-20000.f, 20000.f);
+				}
+			}
+
+			AttackRadiusSq.Init(FMath::Square(150.f), NumEnemies);
+			CombatRadiusSq.Init(FMath::Square(1000.f), NumEnemies);
+			HasTarget.Init(1, NumEnemies);
+			SIMDOut.SetNumZeroed(NumEnemies);
+			ScalarOut.SetNumZeroed(NumEnemies);
+
+			FEnemyStateStore::FRangeKernelArgs Args;
+			Args.PosX = PosX.GetData();
+			Args.PosY = PosY.GetData();
+			Args.PosZ = PosZ.GetData();
+			Args.TargetX = TargetX.GetData();
+			Args.TargetY = TargetY.GetData();
+			Args.TargetZ = TargetZ.GetData();
+			Args.AttackRadiusSq = AttackRadiusSq.GetData();
+			Args.CombatRadiusSq = CombatRadiusSq.GetData();
+			Args.HasTarget = HasTarget.GetData();
+			Args.Num = NumEnemies;
+
+			Args.OutRangeClass = SIMDOut.GetData();
+			const double SIMDStart = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				FEnemyStateStore::ClassifyRangesSIMD(Args);
+			}
+			const double SIMDMicroseconds = (FPlatformTime::Seconds() - SIMDStart) * 1e6 / Iterations;
+
+			Args.OutRangeClass = ScalarOut.GetData();
+			const double ScalarStart = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				FEnemyStateStore::ClassifyRangesScalar(Args);
+			}
+			const double ScalarMicroseconds = (FPlatformTime::Seconds() - ScalarStart) * 1e6 / Iterations;
+
+			const bool bResultsMatch = SIMDOut == ScalarOut;
+
+			UE_LOG(LogOpenWorldRPG, Display,
+				TEXT("EnemyRangeKernel %6d enemies: SIMD %8.2f us, scalar %8.2f us, speedup %.2fx, results %s"),
+				NumEnemies,
+				SIMDMicroseconds,
+				ScalarMicroseconds,
+				ScalarMicroseconds / FMath::Max(SIMDMicroseconds, UE_DOUBLE_SMALL_NUMBER),
+				bResultsMatch ? TEXT("match") : TEXT("DIFFER"));
+		}
+	}));
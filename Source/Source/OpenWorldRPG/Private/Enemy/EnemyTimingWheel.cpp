@@ -0,0 +1,237 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EnemyTimingWheel.h"
+
+// =======================
+// Enemy
+// =======================
+#include "Enemy/Enemy.h"
+
+static constexpr uint64 LevelMask = FEnemyTimingWheel::SlotsPerLevel - 1;
+static constexpr uint64 LevelShift = 8;
+static constexpr uint64 MaxDelayTicks = FEnemyTimingWheel::SlotsPerLevel * FEnemyTimingWheel::SlotsPerLevel - 1;
+
+static_assert(FEnemyTimingWheel::SlotsPerLevel == 1 << LevelShift, "LevelShift must match SlotsPerLevel");
+
+FEnemyTimingWheel::FEnemyTimingWheel()
+{
+	SlotHeads.Init(INDEX_NONE, SlotsPerLevel * NumLevels);
+}
+
+/* =====================================================
+ * Timers
+ * ===================================================== */
+
+FEnemyTimerHandle FEnemyTimingWheel::Arm(AEnemy* Enemy, EEnemyTimer Kind, float DelaySeconds)
+{
+	const int32 Index = AllocateNode();
+	FTimerNode& Node = Nodes[Index];
+
+	// Always at least one tick away, so a timer never fires in the frame it was armed.
+	// Delays past the wheel's span (about half an hour) are clamped to it
+	const uint64 DelayTicks = FMath::Clamp<uint64>(
+		static_cast<uint64>(FMath::CeilToDouble(FMath::Max(0.f, DelaySeconds) / TickSeconds)),
+		1,
+		MaxDelayTicks);
+
+	Node.Enemy = Enemy;
+	Node.Kind = Kind;
+	Node.ExpireTick = CurrentTick + DelayTicks;
+	Link(Index);
+
+	++NumPending;
+	++Churn.Armed;
+
+	FEnemyTimerHandle Handle;
+	Handle.Index = Index;
+	Handle.Generation = Node.Generation;
+	return Handle;
+}
+
+void FEnemyTimingWheel::Cancel(FEnemyTimerHandle& Handle)
+{
+	if (FindPending(Handle))
+	{
+		Unlink(Handle.Index);
+		FreeNode(Handle.Index);
+
+		--NumPending;
+		++Churn.Cancelled;
+	}
+	else if (IsFired(Handle))
+	{
+		// Came due this tick but an earlier callback got to it first
+		FreeNode(Handle.Index);
+		++Churn.Cancelled;
+	}
+
+	Handle.Invalidate();
+}
+
+bool FEnemyTimingWheel::IsPending(const FEnemyTimerHandle& Handle) const
+{
+	return FindPending(Handle) != nullptr;
+}
+
+float FEnemyTimingWheel::GetRemaining(const FEnemyTimerHandle& Handle) const
+{
+	const FTimerNode* Node = FindPending(Handle);
+	if (Node == nullptr) return 0.f;
+
+	return static_cast<float>((Node->ExpireTick - CurrentTick) * TickSeconds - Accumulator);
+}
+
+void FEnemyTimingWheel::Advance(float DeltaSeconds, TArray<FFiredTimer>& OutFired)
+{
+	Accumulator += DeltaSeconds;
+
+	while (Accumulator >= TickSeconds)
+	{
+		Accumulator -= TickSeconds;
+		++CurrentTick;
+
+		if ((CurrentTick & LevelMask) == 0)
+		{
+			Cascade();
+		}
+
+		// Everything in the current first-level slot expires on this tick
+		const int32 Slot = static_cast<int32>(CurrentTick & LevelMask);
+		while (SlotHeads[Slot] != INDEX_NONE)
+		{
+			const int32 Index = SlotHeads[Slot];
+			FTimerNode& Node = Nodes[Index];
+
+			FFiredTimer& Fired = OutFired.AddDefaulted_GetRef();
+			Fired.Enemy = Node.Enemy;
+			Fired.Kind = Node.Kind;
+			Fired.Handle.Index = Index;
+			Fired.Handle.Generation = Node.Generation;
+
+			// Held out of the free list until consumed, so a cancel in an earlier callback still lands
+			Unlink(Index);
+			Nodes[Index].Slot = FiredSlot;
+
+			--NumPending;
+		}
+	}
+}
+
+bool FEnemyTimingWheel::ConsumeFired(const FEnemyTimerHandle& Handle)
+{
+	if (!IsFired(Handle)) return false;
+
+	FreeNode(Handle.Index);
+	++Churn.Fired;
+	return true;
+}
+
+/* =====================================================
+ * Slab
+ * ===================================================== */
+
+int32 FEnemyTimingWheel::AllocateNode()
+{
+	if (FreeHead != INDEX_NONE)
+	{
+		const int32 Index = FreeHead;
+		FreeHead = Nodes[Index].Next;
+		Nodes[Index].Next = INDEX_NONE;
+		return Index;
+	}
+
+	return Nodes.AddDefaulted();
+}
+
+void FEnemyTimingWheel::FreeNode(int32 Index)
+{
+	FTimerNode& Node = Nodes[Index];
+
+	// Bumping the generation is what makes stale handles harmless
+	++Node.Generation;
+	Node.Enemy = nullptr;
+	Node.Slot = INDEX_NONE;
+	Node.Prev = INDEX_NONE;
+	Node.Next = FreeHead;
+	FreeHead = Index;
+}
+
+/* =====================================================
+ * Slots
+ * ===================================================== */
+
+void FEnemyTimingWheel::Link(int32 Index)
+{
+	FTimerNode& Node = Nodes[Index];
+	const uint64 Delta = Node.ExpireTick - CurrentTick;
+
+	const int32 Slot = Delta <= LevelMask
+		? static_cast<int32>(Node.ExpireTick & LevelMask)
+		: SlotsPerLevel + static_cast<int32>((Node.ExpireTick >> LevelShift) & LevelMask);
+
+	Node.Slot = Slot;
+	Node.Prev = INDEX_NONE;
+	Node.Next = SlotHeads[Slot];
+
+	if (Node.Next != INDEX_NONE)
+	{
+		Nodes[Node.Next].Prev = Index;
+	}
+	SlotHeads[Slot] = Index;
+}
+
+void FEnemyTimingWheel::Unlink(int32 Index)
+{
+	FTimerNode& Node = Nodes[Index];
+
+	if (Node.Prev != INDEX_NONE)
+	{
+		Nodes[Node.Prev].Next = Node.Next;
+	}
+	else
+	{
+		SlotHeads[Node.Slot] = Node.Next;
+	}
+
+	if (Node.Next != INDEX_NONE)
+	{
+		Nodes[Node.Next].Prev = Node.Prev;
+	}
+
+	Node.Prev = INDEX_NONE;
+	Node.Next = INDEX_NONE;
+	Node.Slot = INDEX_NONE;
+}
+
+void FEnemyTimingWheel::Cascade()
+{
+	const int32 Slot = SlotsPerLevel + static_cast<int32>((CurrentTick >> LevelShift) & LevelMask);
+
+	// Everything here expires within the next 256 ticks, so it all lands in the first level
+	int32 Index = SlotHeads[Slot];
+	SlotHeads[Slot] = INDEX_NONE;
+
+	while (Index != INDEX_NONE)
+	{
+		const int32 Next = Nodes[Index].Next;
+		Link(Index);
+		Index = Next;
+	}
+}
+
+const FEnemyTimingWheel::FTimerNode* FEnemyTimingWheel::FindPending(const FEnemyTimerHandle& Handle) const
+{
+	if (!Nodes.IsValidIndex(Handle.Index)) return nullptr;
+
+	const FTimerNode& Node = Nodes[Handle.Index];
+	if (Node.Generation != Handle.Generation || Node.Slot < 0) return nullptr;
+
+	return &Node;
+}
+
+bool FEnemyTimingWheel::IsFired(const FEnemyTimerHandle& Handle) const
+{
+	return Nodes.IsValidIndex(Handle.Index) &&
+		Nodes[Handle.Index].Generation == Handle.Generation &&
+		Nodes[Handle.Index].Slot == FiredSlot;
+}
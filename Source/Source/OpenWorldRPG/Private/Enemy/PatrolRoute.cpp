@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/PatrolRoute.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "Algo/BinarySearch.h"
+#include "HAL/IConsoleManager.h"
+#include "OpenWorldRPG.h"
+
+/* =====================================================
+ * Constructor
+ * ===================================================== */
+
+APatrolRoute::APatrolRoute()
+{
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+/* =====================================================
+ * Traversal
+ * ===================================================== */
+
+int32 APatrolRoute::ChooseNextWaypoint(int32 CurrentIndex) const
+{
+	const int32 NumWaypoints = RouteWaypoints.Num();
+	if (NumWaypoints == 0) return INDEX_NONE;
+
+	if (Traversal == EPatrolTraversal::EPT_Sequential)
+	{
+		return RouteWaypoints.IsValidIndex(CurrentIndex) ? (CurrentIndex + 1) % NumWaypoints : 0;
+	}
+
+	// FRand can return exactly 1, which would land past the last bucket
+	const float Random01 = FMath::Min(FMath::FRand(), 1.f - UE_KINDA_SMALL_NUMBER);
+	return SelectWeightedExcluding(CumulativeWeights, CurrentIndex, Random01);
+}
+
+int32 APatrolRoute::SelectWeightedExcluding(TArrayView<const float> CumulativeWeights, int32 ExcludedIndex, float Random01)
+{
+	const int32 Num = CumulativeWeights.Num();
+	if (Num <= 1) return Num - 1;
+
+	const bool bExcluding = CumulativeWeights.IsValidIndex(ExcludedIndex);
+	const float ExcludedStart = bExcluding && ExcludedIndex > 0 ? CumulativeWeights[ExcludedIndex - 1] : 0.f;
+	const float ExcludedWeight = bExcluding ? CumulativeWeights[ExcludedIndex] - ExcludedStart : 0.f;
+	const float Available = CumulativeWeights.Last() - ExcludedWeight;
+
+	// Every other waypoint weighted zero: treat them as equally likely
+	if (Available <= 0.f)
+	{
+		return SelectUniformExcluding(Num, ExcludedIndex, Random01);
+	}
+
+	// Sample the remaining weight, then step over the excluded waypoint's span
+	float Pick = Random01 * Available;
+	if (bExcluding && Pick >= ExcludedStart)
+	{
+		Pick += ExcludedWeight;
+	}
+
+	return FMath::Min(Algo::UpperBound(CumulativeWeights, Pick), Num - 1);
+}
+
+int32 APatrolRoute::SelectUniformExcluding(int32 Num, int32 ExcludedIndex, float Random01)
+{
+	if (Num <= 1) return Num - 1;
+
+	if (ExcludedIndex < 0 || ExcludedIndex >= Num)
+	{
+		return FMath::Min(FMath::FloorToInt32(Random01 * Num), Num - 1);
+	}
+
+	const int32 Selection = FMath::Min(FMath::FloorToInt32(Random01 * (Num - 1)), Num - 2);
+	return Selection >= ExcludedIndex ? Selection + 1 : Selection;
+}
+
+/* =====================================================
+ * <Actor> Overrides
+ * ===================================================== */
+
+void APatrolRoute::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	BuildRoute();
+}
+
+#if WITH_EDITOR
+void APatrolRoute::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	BuildRoute();
+}
+#endif
+
+void APatrolRoute::BuildRoute()
+{
+	RouteWaypoints.Reset(Waypoints.Num());
+	CumulativeWeights.Reset(Waypoints.Num());
+
+	float RunningWeight = 0.f;
+
+	for (int32 Index = 0; Index < Waypoints.Num(); ++Index)
+	{
+		if (Waypoints[Index] == nullptr) continue;
+
+		RunningWeight += Weights.IsValidIndex(Index) ? FMath::Max(0.f, Weights[Index]) : 1.f;
+
+		RouteWaypoints.Add(Waypoints[Index]);
+		CumulativeWeights.Add(RunningWeight);
+	}
+}
+
+/* =====================================================
+ * Benchmark
+ * ===================================================== */
+
+// The selection AEnemy::ChoosePatrolTarget used to do: rebuild a candidate list with AddUnique every call
+static int32 SelectLegacy(const TArray<int32>& Waypoints, int32 CurrentWaypoint)
+{
+	TArray<int32> ValidTargets;
+
+	for (const int32 Waypoint : Waypoints)
+	{
+		if (Waypoint != CurrentWaypoint)
+		{
+			ValidTargets.AddUnique(Waypoint);
+		}
+	}
+
+	return ValidTargets.Num() > 0 ? ValidTargets[FMath::RandRange(0, ValidTargets.Num() - 1)] : INDEX_NONE;
+}
+
+// Times legacy, weighted and sequential selection: rpg.Bench.PatrolSelection [Iterations]
+static FAutoConsoleCommand BenchPatrolSelectionCommand(
+	TEXT("rpg.Bench.PatrolSelection"),
+	TEXT("Times legacy patrol target selection against patrol route selection at 16, 256 and 4096 waypoints."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& CommandArgs)
+	{
+		const int32 Iterations = CommandArgs.Num() > 0 ? FMath::Max(1, FCString::Atoi(*CommandArgs[0])) : 2000;
+		const int32 WaypointCounts[] = { 16, 256, 4096 };
+
+		FRandomStream Random(1337);
+
+		for (const int32 NumWaypoints : WaypointCounts)
+		{
+			TArray<int32> Waypoints;
+			TArray<float> CumulativeWeights;
+			float RunningWeight = 0.f;
+
+			for (int32 Index = 0; Index < NumWaypoints; ++Index)
+			{
+				Waypoints.Add(Index);
+				RunningWeight += Random.FRandRange(0.5f, 2.f);
+				CumulativeWeights.Add(RunningWeight);
+			}
+
+			// The legacy path is quadratic, so it gets fewer iterations at large counts
+			const int32 LegacyIterations = FMath::Clamp(Iterations * 16 / NumWaypoints, 1, Iterations);
+
+			int32 Current = 0;
+			const double LegacyStart = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < LegacyIterations; ++Iteration)
+			{
+				Current = SelectLegacy(Waypoints, Current);
+			}
+			const double LegacyMicroseconds = (FPlatformTime::Seconds() - LegacyStart) * 1e6 / LegacyIterations;
+
+			Current = 0;
+			const double WeightedStart = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				Current = APatrolRoute::SelectWeightedExcluding(CumulativeWeights, Current, Random.GetFraction());
+			}
+			const double WeightedMicroseconds = (FPlatformTime::Seconds() - WeightedStart) * 1e6 / Iterations;
+
+			Current = 0;
+			const double UniformStart = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				Current = APatrolRoute::SelectUniformExcluding(NumWaypoints, Current, Random.GetFraction());
+			}
+			const double UniformMicroseconds = (FPlatformTime::Seconds() - UniformStart) * 1e6 / Iterations;
+
+			UE_LOG(LogOpenWorldRPG, Display,
+				TEXT("PatrolSelection %5d waypoints: legacy %10.3f us, weighted %7.3f us, uniform %7.3f us per pick"),
+				NumWaypoints,
+				LegacyMicroseconds,
+				WeightedMicroseconds,
+				UniformMicroseconds);
+		}
+	}));
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HUD/SlashHUDModel.h"
+#include "Components/ProgressBar.h"
+#include "Components/TextBlock.h"
+
+void FSlashHUDModel::SetHealthPercent(float Percent)
+{
+	if (FMath::IsNearlyEqual(HealthPercent, Percent, PercentTolerance)) return;
+
+	HealthPercent = Percent;
+	DirtyFields |= EField::Health;
+}
+
+void FSlashHUDModel::SetStaminaPercent(float Percent)
+{
+	if (FMath::IsNearlyEqual(StaminaPercent, Percent, PercentTolerance)) return;
+
+	StaminaPercent = Percent;
+	DirtyFields |= EField::Stamina;
+}
+
+void FSlashHUDModel::SetGold(int32 Gold)
+{
+	if (GoldAmount == Gold) return;
+
+	GoldAmount = Gold;
+	DirtyFields |= EField::Gold;
+}
+
+void FSlashHUDModel::SetSouls(int32 Souls)
+{
+	if (SoulsAmount == Souls) return;
+
+	SoulsAmount = Souls;
+	DirtyFields |= EField::Souls;
+}
+
+void FSlashHUDModel::Flush(UProgressBar* HealthBar, UProgressBar* StaminaBar, UTextBlock* GoldText, UTextBlock* SoulsText)
+{
+	LastNumUpdates = 0;
+
+	if ((DirtyFields & EField::Health) && HealthBar)
+	{
+		HealthBar->SetPercent(HealthPercent);
+		++LastNumUpdates;
+	}
+
+	if ((DirtyFields & EField::Stamina) && StaminaBar)
+	{
+		StaminaBar->SetPercent(StaminaPercent);
+		++LastNumUpdates;
+	}
+
+	//formatted here, once per change, instead of on every pickup
+	if ((DirtyFields & EField::Gold) && GoldText)
+	{
+		GoldText->SetText(FText::AsNumber(GoldAmount, &FNumberFormattingOptions::DefaultNoGrouping()));
+		++LastNumUpdates;
+	}
+
+	if ((DirtyFields & EField::Souls) && SoulsText)
+	{
+		SoulsText->SetText(FText::AsNumber(SoulsAmount, &FNumberFormattingOptions::DefaultNoGrouping()));
+		++LastNumUpdates;
+	}
+
+	DirtyFields = 0;
+}
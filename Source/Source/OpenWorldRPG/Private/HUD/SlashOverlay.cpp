@@ -4,36 +4,38 @@
 #include "HUD/SlashOverlay.h"
 #include "Components/ProgressBar.h"
 #include "Components/TextBlock.h"
+#include "OpenWorldRPG.h"
 
+//setters only record into the model, widgets are touched once per frame in NativeTick
 
 void USlashOverlay::SetHealthBarPercent(float Percent)
 {
-	if (HealthProgressBar)
-	{
-		HealthProgressBar->SetPercent(Percent);
-	}
+	HUDModel.SetHealthPercent(Percent);
 }
 
 void USlashOverlay::SetStaminaBarPercent(float Percent)
 {
-	if (StaminaProgressBar)
-	{
-		StaminaProgressBar->SetPercent(Percent);
-	}
+	HUDModel.SetStaminaPercent(Percent);
 }
 
 void USlashOverlay::SetGold(int32 Gold)
 {
-	if (GoldText)
-	{
-		GoldText->SetText(FText::FromString(FString::Printf(TEXT("%d"), Gold)));
-	}
+	HUDModel.SetGold(Gold);
 }
 
 void USlashOverlay::SetSouls(int32 Souls)
 {
-	if (SoulsText)
-	{
-		SoulsText->SetText(FText::FromString(FString::Printf(TEXT("%d"), Souls)));
-	}
+	HUDModel.SetSouls(Souls);
+}
+
+void USlashOverlay::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+{
+	Super::NativeTick(MyGeometry, InDeltaTime);
+
+	//nothing changed, nothing to invalidate
+	if (!HUDModel.IsDirty()) return;
+
+	RPG_SCOPE_CYCLE_COUNTER(HUDUpdate);
+
+	HUDModel.Flush(HealthProgressBar, StaminaProgressBar, GoldText, SoulsText);
 }
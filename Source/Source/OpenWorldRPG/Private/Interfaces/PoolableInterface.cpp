@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Interfaces/PoolableInterface.h"
+
+// Add default functionality here for any IPoolableInterface functions that are not pure virtual.
+
+void IPoolableInterface::OnAcquiredFromPool()
+{
+}
+
+void IPoolableInterface::OnReleasedToPool()
+{
+}
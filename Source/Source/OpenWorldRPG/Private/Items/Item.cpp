@@ -8,22 +8,27 @@
 #include "NiagaraFunctionLibrary.h"
 #include "NiagaraComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "Spatial/SpatialHashSubsystem.h"
+#include "Items/ItemAnimationSubsystem.h"
+#include "OpenWorldRPG.h"
 
 //Sets default values
 AItem::AItem()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	//hover bob is batched in UItemAnimationSubsystem, items never tick themselves
+	PrimaryActorTick.bCanEverTick = false;
 
 	ItemMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("ItemMeshComponent"));
 	ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 	ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	RootComponent = ItemMesh;
 
-	//collisions
+	//pickup range, UPickupProximitySubsystem reads its radius so it needs no collision
 	Sphere = CreateDefaultSubobject<USphereComponent>(TEXT("Sphere"));
 	
 	Sphere->SetupAttachment(GetRootComponent());
+	Sphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Sphere->SetGenerateOverlapEvents(false);
 
 	//niagara
 
@@ -51,51 +56,95 @@ void AItem::BeginPlay()
 		UE_LOG(LogTemp, Warning, TEXT("Sphere Exists!"));
 	}*/
 
-	//callback bind to delegate
-	Sphere->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnSphereOverlap);
-	Sphere->OnComponentEndOverlap.AddDynamic(this, &AItem::OnSphereEndOverlap);
-	
+	//items sit still, so they only enter the spatial hash once
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->RegisterActor(this, ESpatialCategory::Item, false);
+	}
+
+	if (ItemState == EItemState::EIS_Hovering)
+	{
+		HoverRestLocation = GetActorLocation();
+		StartHovering();
+	}
 }
 
-void AItem::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	const FString OtherActorName = OtherActor->GetName();
-	if (GEngine) 
+	StopHovering();
+
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 30.f, FColor::Red, OtherActorName);
+		SpatialHash->UnregisterActor(this);
 	}
 
-	IPickupInterface* PickupInterface = Cast<IPickupInterface>(OtherActor);
-	if (PickupInterface)
+	Super::EndPlay(EndPlayReason);
+}
+
+void AItem::OnAcquiredFromPool()
+{
+	//the pool has already moved us, so the bob starts from the new spot
+	SetItemState(EItemState::EIS_Hovering);
+
+	if (ItemEffect)
 	{
-		PickupInterface->SetOverlappingItem(this);
+		ItemEffect->Activate(true);
 	}
 
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->RegisterActor(this, ESpatialCategory::Item, false);
+	}
 }
 
-void AItem::OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+void AItem::OnReleasedToPool()
 {
-	const FString OtherActorName = FString ("Ending Overlap with: ") + OtherActor->GetName();
-	if (GEngine)
+	StopHovering();
+
+	if (ItemEffect)
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 30.f, FColor::Red, OtherActorName);
+		ItemEffect->Deactivate();
 	}
 
-	IPickupInterface* PickupInterface = Cast<IPickupInterface>(OtherActor);
-	if (PickupInterface)
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
 	{
-		PickupInterface->SetOverlappingItem(nullptr);
+		SpatialHash->UnregisterActor(this);
 	}
 }
 
+void AItem::OnPickupRangeEntered(IPickupInterface* Picker)
+{
+	RPG_SCOPE_CYCLE_COUNTER(Pickups);
+
+	Picker->SetOverlappingItem(this);
+}
+
+void AItem::OnPickupRangeExited(IPickupInterface* Picker)
+{
+	RPG_SCOPE_CYCLE_COUNTER(Pickups);
+
+	Picker->SetOverlappingItem(nullptr);
+}
+
+float AItem::GetPickupRadius() const
+{
+	return Sphere->GetScaledSphereRadius();
+}
+
 void AItem::SpawnPickupSystem()
 {
 	if (PickupEffect)
 	{
+		//auto release hands the component back to the engine's niagara pool when it finishes
 		UNiagaraFunctionLibrary::SpawnSystemAtLocation(
 			this,
 			PickupEffect,
-			GetActorLocation()
+			GetActorLocation(),
+			FRotator::ZeroRotator,
+			FVector(1.f),
+			true,
+			true,
+			ENCPoolMethod::AutoRelease
 		);
 	}
 }
@@ -112,33 +161,42 @@ void AItem::SpawnPickupSound()
 	}
 }
 
-float AItem::TransformedSin() const
+void AItem::SetItemState(EItemState NewState)
 {
-	return Amplitude * FMath::Sin(RunningTime * TimeConstant);
-}
+	ItemState = NewState;
 
-// Called every frame
-void AItem::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-	//UE_LOG(LogTemp, Warning, TEXT("DeltaTime: %f"), DeltaTime);
-
-	RunningTime += DeltaTime;
-    
-	const float z = TransformedSin(); // period = 2*pi/K
 	if (ItemState == EItemState::EIS_Hovering)
 	{
-		AddActorWorldOffset(FVector(0.f, 0.f, TransformedSin()));
+		//an item already bobbing is off its rest height, so only a fresh hover reads the location
+		if (!bHovering)
+		{
+			HoverRestLocation = GetActorLocation();
+		}
+		StartHovering();
 	}
+	else
+	{
+		//equipped items stop costing anything per frame
+		StopHovering();
+	}
+}
 
-	//if (GEngine)
-	//{
-	//	//.f specifies it is a float value
-	//	FString Message = FString::Printf(TEXT("DeltaTime: %f"), DeltaTime);
-	//	GEngine->AddOnScreenDebugMessage(1, 60.f, FColor::Cyan, Message);
-
-	//}
+void AItem::StartHovering()
+{
+	bHovering = true;
 
+	if (UItemAnimationSubsystem* ItemAnimation = GetWorld()->GetSubsystem<UItemAnimationSubsystem>())
+	{
+		ItemAnimation->AddItem(this, HoverRestLocation, Amplitude, TimeConstant);
+	}
 }
 
+void AItem::StopHovering()
+{
+	bHovering = false;
 
+	if (UItemAnimationSubsystem* ItemAnimation = GetWorld()->GetSubsystem<UItemAnimationSubsystem>())
+	{
+		ItemAnimation->RemoveItem(this);
+	}
+}
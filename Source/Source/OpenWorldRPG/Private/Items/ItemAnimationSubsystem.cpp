@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Items/ItemAnimationSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "OpenWorldRPG.h"
+
+// =======================
+// Items
+// =======================
+#include "Items/Item.h"
+
+/* =====================================================
+ * Console Variables
+ * ===================================================== */
+
+static TAutoConsoleVariable<float> CVarItemAnimationRelevanceRadius(
+	TEXT("rpg.ItemAnimation.RelevanceRadius"),
+	2000.f,
+	TEXT("Hovering items within this distance of a player keep bobbing even when off screen."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarItemAnimationRenderedTolerance(
+	TEXT("rpg.ItemAnimation.RenderedTolerance"),
+	0.2f,
+	TEXT("Hovering items rendered within this many seconds keep bobbing at any distance."),
+	ECVF_Default);
+
+/* =====================================================
+ * Registration
+ * ===================================================== */
+
+void UItemAnimationSubsystem::AddItem(AItem* Item, const FVector& RestLocation, float Amplitude, float TimeConstant)
+{
+	if (Item == nullptr) return;
+
+	if (const int32* ExistingIndex = ItemToIndex.Find(TWeakObjectPtr<AItem>(Item)))
+	{
+		BaseLocations[*ExistingIndex] = RestLocation;
+		RunningTimes[*ExistingIndex] = 0.f;
+		Amplitudes[*ExistingIndex] = Amplitude;
+		TimeConstants[*ExistingIndex] = TimeConstant;
+		return;
+	}
+
+	const int32 Index = Items.Add(Item);
+	BaseLocations.Add(RestLocation);
+	RunningTimes.Add(0.f);
+	Amplitudes.Add(Amplitude);
+	TimeConstants.Add(TimeConstant);
+	Offsets.Add(0.f);
+
+	ItemToIndex.Add(TWeakObjectPtr<AItem>(Item), Index);
+}
+
+void UItemAnimationSubsystem::RemoveItem(AItem* Item)
+{
+	int32 Index = INDEX_NONE;
+	if (ItemToIndex.RemoveAndCopyValue(TWeakObjectPtr<AItem>(Item), Index))
+	{
+		RemoveAt(Index);
+	}
+}
+
+void UItemAnimationSubsystem::RemoveAt(int32 Index)
+{
+	Items.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	BaseLocations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	RunningTimes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Amplitudes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TimeConstants.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Offsets.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	// The last item moved into the freed index
+	if (Items.IsValidIndex(Index))
+	{
+		ItemToIndex.Add(Items[Index], Index);
+	}
+}
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UItemAnimationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	LastNumMoved = 0;
+
+	const int32 NumItems = Items.Num();
+	if (NumItems == 0) return;
+
+	RPG_SCOPE_CYCLE_COUNTER(ItemAnimation);
+
+	// Every bob is evaluated, visible or not, so items keep their phase while off screen
+	for (int32 Index = 0; Index < NumItems; ++Index)
+	{
+		RunningTimes[Index] += DeltaTime;
+		Offsets[Index] = TransformedSin(Amplitudes[Index], TimeConstants[Index], RunningTimes[Index]);
+	}
+
+	RefreshPlayerLocations();
+
+	const double RelevanceRadiusSquared = FMath::Square(CVarItemAnimationRelevanceRadius.GetValueOnGameThread());
+	const float RenderedTolerance = CVarItemAnimationRenderedTolerance.GetValueOnGameThread();
+
+	for (int32 Index = NumItems - 1; Index >= 0; --Index)
+	{
+		AItem* Item = Items[Index].Get();
+		if (Item == nullptr)
+		{
+			ItemToIndex.Remove(Items[Index]);
+			RemoveAt(Index);
+			continue;
+		}
+
+		if (!IsRelevant(Item, BaseLocations[Index], RelevanceRadiusSquared, RenderedTolerance)) continue;
+
+		// Teleport: nothing physical is pushed along by a bobbing pickup
+		Item->SetActorLocation(
+			BaseLocations[Index] + FVector(0.f, 0.f, Offsets[Index]),
+			false,
+			nullptr,
+			ETeleportType::TeleportPhysics);
+
+		++LastNumMoved;
+	}
+}
+
+TStatId UItemAnimationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemAnimationSubsystem, STATGROUP_Tickables);
+}
+
+bool UItemAnimationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Relevance
+ * ===================================================== */
+
+bool UItemAnimationSubsystem::IsRelevant(
+	const AItem* Item,
+	const FVector& BaseLocation,
+	double RelevanceRadiusSquared,
+	float RenderedTolerance) const
+{
+	if (Item->WasRecentlyRendered(RenderedTolerance)) return true;
+
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		if (FVector::DistSquared(BaseLocation, PlayerLocation) <= RelevanceRadiusSquared) return true;
+	}
+
+	return false;
+}
+
+void UItemAnimationSubsystem::RefreshPlayerLocations()
+{
+	PlayerLocations.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+		if (Pawn)
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+}
@@ -0,0 +1,320 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Items/LootAggregationSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "OpenWorldRPG.h"
+
+// =======================
+// Items / Spatial / Pooling
+// =======================
+#include "Items/Item.h"
+#include "Items/Soul.h"
+#include "Items/Treasure.h"
+#include "Interfaces/PickupInterface.h"
+#include "Spatial/SpatialHashSubsystem.h"
+#include "Pooling/ActorPoolSubsystem.h"
+
+/* =====================================================
+ * Console Variables
+ * ===================================================== */
+
+static TAutoConsoleVariable<float> CVarLootMergeRadius(
+	TEXT("rpg.Loot.MergeRadius"),
+	300.f,
+	TEXT("Souls and treasure dropped within this distance of a hovering pickup of the same class merge into it. 0 disables merging."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLootVacuumRadius(
+	TEXT("rpg.Loot.VacuumRadius"),
+	0.f,
+	TEXT("Souls and treasure within this distance of a player are pulled in and collected. 0 disables the vacuum."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLootVacuumSpeed(
+	TEXT("rpg.Loot.VacuumSpeed"),
+	1500.f,
+	TEXT("Speed (units/s) vacuumed pickups fly towards the player."),
+	ECVF_Default);
+
+// Close enough to the player's location to count as collected
+static constexpr double VacuumArrivalRadius = 50.0;
+
+/* =====================================================
+ * Drops
+ * ===================================================== */
+
+ASoul* ULootAggregationSubsystem::DropSouls(TSubclassOf<ASoul> SoulClass, const FTransform& Transform, int32 Souls)
+{
+	if (SoulClass == nullptr) return nullptr;
+
+	if (ASoul* MergeTarget = Cast<ASoul>(FindMergeTarget(SoulClass, Transform.GetLocation())))
+	{
+		MergeTarget->SetSouls(MergeTarget->GetSouls() + Souls);
+		++NumMerged;
+		return MergeTarget;
+	}
+
+	UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	ASoul* SpawnedSoul = Pool ? Pool->Acquire<ASoul>(SoulClass, Transform) : nullptr;
+
+	if (SpawnedSoul)
+	{
+		SpawnedSoul->SetSouls(Souls);
+	}
+	return SpawnedSoul;
+}
+
+ATreasure* ULootAggregationSubsystem::DropTreasure(TSubclassOf<ATreasure> TreasureClass, const FTransform& Transform)
+{
+	if (TreasureClass == nullptr) return nullptr;
+
+	if (ATreasure* MergeTarget = Cast<ATreasure>(FindMergeTarget(TreasureClass, Transform.GetLocation())))
+	{
+		MergeTarget->SetGold(MergeTarget->GetGold() + TreasureClass.GetDefaultObject()->GetGold());
+		++NumMerged;
+		return MergeTarget;
+	}
+
+	UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	return Pool ? Pool->Acquire<ATreasure>(TreasureClass, Transform) : nullptr;
+}
+
+AItem* ULootAggregationSubsystem::FindMergeTarget(UClass* PickupClass, const FVector& Location) const
+{
+	const double MergeRadius = CVarLootMergeRadius.GetValueOnGameThread();
+	if (MergeRadius <= 0.0) return nullptr;
+
+	const USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>();
+	if (SpatialHash == nullptr) return nullptr;
+
+	AItem* Nearest = nullptr;
+	double NearestDistSquared = TNumericLimits<double>::Max();
+
+	SpatialHash->ForEachInRadius(Location, MergeRadius, ESpatialCategory::Item,
+		[&](AActor* Actor, double DistSquared)
+		{
+			AItem* Item = Cast<AItem>(Actor);
+
+			// Claimed pickups are already on their way to a player
+			if (Item == nullptr || Item->GetClass() != PickupClass || Item->GetItemState() != EItemState::EIS_Hovering) return;
+
+			if (DistSquared < NearestDistSquared)
+			{
+				Nearest = Item;
+				NearestDistSquared = DistSquared;
+			}
+		});
+
+	return Nearest;
+}
+
+/* =====================================================
+ * Collection
+ * ===================================================== */
+
+void ULootAggregationSubsystem::QueueCollection(IPickupInterface* Picker, AItem* Pickup)
+{
+	if (Picker == nullptr || Pickup == nullptr) return;
+
+	Pickup->SetItemState(EItemState::EIS_Collecting);
+
+	UObject* PickerObject = Picker->_getUObject();
+	FCollectionBatch* Batch = Batches.FindByPredicate(
+		[PickerObject](const FCollectionBatch& Existing) { return Existing.Picker.Get() == PickerObject; });
+
+	if (Batch == nullptr)
+	{
+		Batch = &Batches.AddDefaulted_GetRef();
+		Batch->Picker = PickerObject;
+	}
+
+	if (ASoul* Soul = Cast<ASoul>(Pickup))
+	{
+		Batch->Souls.Add(Soul);
+	}
+	else if (ATreasure* Treasure = Cast<ATreasure>(Pickup))
+	{
+		Batch->Treasures.Add(Treasure);
+	}
+}
+
+void ULootAggregationSubsystem::FlushBatches()
+{
+	for (FCollectionBatch& Batch : Batches)
+	{
+		FlushBatch(Batch);
+		++NumBatchesFlushed;
+	}
+
+	Batches.Reset();
+}
+
+void ULootAggregationSubsystem::FlushBatch(FCollectionBatch& Batch)
+{
+	IPickupInterface* Picker = Cast<IPickupInterface>(Batch.Picker.Get());
+
+	// The first soul carries the whole batch, so the interface and the HUD see one pickup
+	ASoul* SoulCarrier = nullptr;
+	int32 TotalSouls = 0;
+
+	for (const TWeakObjectPtr<ASoul>& WeakSoul : Batch.Souls)
+	{
+		if (ASoul* Soul = WeakSoul.Get())
+		{
+			TotalSouls += Soul->GetSouls();
+			SoulCarrier = SoulCarrier ? SoulCarrier : Soul;
+		}
+	}
+
+	if (Picker && SoulCarrier)
+	{
+		SoulCarrier->SetSouls(TotalSouls);
+		Picker->AddSouls(SoulCarrier);
+		SoulCarrier->SpawnPickupSystem();
+		SoulCarrier->SpawnPickupSound();
+	}
+
+	ATreasure* GoldCarrier = nullptr;
+	int32 TotalGold = 0;
+
+	for (const TWeakObjectPtr<ATreasure>& WeakTreasure : Batch.Treasures)
+	{
+		if (ATreasure* Treasure = WeakTreasure.Get())
+		{
+			TotalGold += Treasure->GetGold();
+			GoldCarrier = GoldCarrier ? GoldCarrier : Treasure;
+		}
+	}
+
+	if (Picker && GoldCarrier)
+	{
+		GoldCarrier->SetGold(TotalGold);
+		Picker->AddGold(GoldCarrier);
+		GoldCarrier->SpawnPickupSound();
+	}
+
+	for (const TWeakObjectPtr<ASoul>& WeakSoul : Batch.Souls)
+	{
+		if (ASoul* Soul = WeakSoul.Get())
+		{
+			UActorPoolSubsystem::ReleaseOrDestroy(Soul);
+		}
+	}
+
+	for (const TWeakObjectPtr<ATreasure>& WeakTreasure : Batch.Treasures)
+	{
+		if (ATreasure* Treasure = WeakTreasure.Get())
+		{
+			UActorPoolSubsystem::ReleaseOrDestroy(Treasure);
+		}
+	}
+}
+
+/* =====================================================
+ * Vacuum
+ * ===================================================== */
+
+void ULootAggregationSubsystem::StartVacuum(float VacuumRadius)
+{
+	const USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>();
+	if (SpatialHash == nullptr) return;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		APawn* Player = PlayerController ? PlayerController->GetPawn() : nullptr;
+		if (Cast<IPickupInterface>(Player) == nullptr) continue;
+
+		NearbyActors.Reset();
+		SpatialHash->QueryRadius(Player->GetActorLocation(), VacuumRadius, ESpatialCategory::Item, NearbyActors);
+
+		for (AActor* Actor : NearbyActors)
+		{
+			AItem* Item = Cast<AItem>(Actor);
+			const bool bIsLoot = Cast<ASoul>(Item) || Cast<ATreasure>(Item);
+
+			if (bIsLoot && Item->GetItemState() == EItemState::EIS_Hovering && !Item->IsHidden())
+			{
+				Item->SetItemState(EItemState::EIS_Collecting);
+				Vacuumed.Add({ Item, Player });
+			}
+		}
+	}
+}
+
+void ULootAggregationSubsystem::UpdateVacuum(float DeltaTime)
+{
+	const float VacuumSpeed = CVarLootVacuumSpeed.GetValueOnGameThread();
+
+	for (int32 Index = Vacuumed.Num() - 1; Index >= 0; --Index)
+	{
+		AItem* Item = Vacuumed[Index].Pickup.Get();
+		APawn* Player = Vacuumed[Index].Player.Get();
+
+		if (Item == nullptr || Player == nullptr)
+		{
+			// Nobody to fly to, settle down where it is
+			if (Item)
+			{
+				Item->SetItemState(EItemState::EIS_Hovering);
+
+				if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+				{
+					SpatialHash->UpdateActorLocation(Item);
+				}
+			}
+
+			Vacuumed.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		const FVector Target = Player->GetActorLocation();
+		const FVector NewLocation = FMath::VInterpConstantTo(Item->GetActorLocation(), Target, DeltaTime, VacuumSpeed);
+		Item->SetActorLocation(NewLocation, false, nullptr, ETeleportType::TeleportPhysics);
+
+		if (FVector::DistSquared(NewLocation, Target) <= FMath::Square(VacuumArrivalRadius))
+		{
+			QueueCollection(Cast<IPickupInterface>(Player), Item);
+			Vacuumed.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+		}
+	}
+}
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void ULootAggregationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const float VacuumRadius = CVarLootVacuumRadius.GetValueOnGameThread();
+	if (VacuumRadius <= 0.f && Vacuumed.Num() == 0 && Batches.Num() == 0) return;
+
+	RPG_SCOPE_CYCLE_COUNTER(Pickups);
+
+	if (VacuumRadius > 0.f)
+	{
+		StartVacuum(VacuumRadius);
+	}
+
+	UpdateVacuum(DeltaTime);
+	FlushBatches();
+}
+
+TStatId ULootAggregationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULootAggregationSubsystem, STATGROUP_Tickables);
+}
+
+bool ULootAggregationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
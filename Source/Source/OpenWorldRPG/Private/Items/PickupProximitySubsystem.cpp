@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Items/PickupProximitySubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+#include "OpenWorldRPG.h"
+
+// =======================
+// Items / Spatial
+// =======================
+#include "Items/Item.h"
+#include "Interfaces/PickupInterface.h"
+#include "Spatial/SpatialHashSubsystem.h"
+
+/* =====================================================
+ * Console Variables
+ * ===================================================== */
+
+static TAutoConsoleVariable<float> CVarPickupQueryRate(
+	TEXT("rpg.Pickup.QueryRate"),
+	20.f,
+	TEXT("Pickup proximity queries per second for each player."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPickupQueryRadius(
+	TEXT("rpg.Pickup.QueryRadius"),
+	600.f,
+	TEXT("Spatial hash search radius around a player, must cover the largest item pickup radius plus the capsule."),
+	ECVF_Default);
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UPickupProximitySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const float QueryInterval = 1.f / FMath::Max(CVarPickupQueryRate.GetValueOnGameThread(), 1.f);
+
+	// A long hitch runs one query, not a burst of them
+	TimeSinceQuery = FMath::Min(TimeSinceQuery + DeltaTime, QueryInterval);
+	if (TimeSinceQuery < QueryInterval) return;
+	TimeSinceQuery = 0.f;
+
+	RPG_SCOPE_CYCLE_COUNTER(Pickups);
+
+	for (auto It = Watchers.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		APawn* Player = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+		if (Cast<IPickupInterface>(Player))
+		{
+			UpdateWatcher(Player, Watchers.FindOrAdd(Player));
+		}
+	}
+}
+
+TStatId UPickupProximitySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPickupProximitySubsystem, STATGROUP_Tickables);
+}
+
+bool UPickupProximitySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Proximity
+ * ===================================================== */
+
+void UPickupProximitySubsystem::UpdateWatcher(APawn* Player, FPickupWatcher& Watcher)
+{
+	const USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>();
+	if (SpatialHash == nullptr) return;
+
+	NearbyActors.Reset();
+	SpatialHash->QueryRadius(
+		Player->GetActorLocation(),
+		CVarPickupQueryRadius.GetValueOnGameThread(),
+		ESpatialCategory::Item,
+		NearbyActors);
+
+	NowInRange.Reset();
+	for (AActor* Actor : NearbyActors)
+	{
+		AItem* Item = Cast<AItem>(Actor);
+		if (Item && Item->GetItemState() == EItemState::EIS_Hovering && IsInPickupRange(Player, Item))
+		{
+			NowInRange.Add(Item);
+		}
+	}
+
+	// Swap first, callbacks may collect an item and pool it mid-loop
+	Swap(Watcher.InRange, NowInRange);
+
+	IPickupInterface* Picker = Cast<IPickupInterface>(Player);
+
+	for (const TWeakObjectPtr<AItem>& WasInRange : NowInRange)
+	{
+		AItem* Item = WasInRange.Get();
+
+		// Pooled and equipped items left the world rather than the player's reach
+		if (Item == nullptr || Item->IsHidden() || Item->GetItemState() != EItemState::EIS_Hovering) continue;
+
+		if (!Watcher.InRange.Contains(WasInRange))
+		{
+			Item->OnPickupRangeExited(Picker);
+		}
+	}
+
+	for (const TWeakObjectPtr<AItem>& IsInRange : Watcher.InRange)
+	{
+		AItem* Item = IsInRange.Get();
+		if (Item == nullptr || NowInRange.Contains(IsInRange)) continue;
+
+		Item->OnPickupRangeEntered(Picker);
+	}
+}
+
+bool UPickupProximitySubsystem::IsInPickupRange(const APawn* Player, const AItem* Item)
+{
+	const FVector Delta = Item->GetActorLocation() - Player->GetActorLocation();
+	const double PickupRadius = Item->GetPickupRadius();
+
+	if (const ACharacter* Character = Cast<ACharacter>(Player))
+	{
+		const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+		const double Reach = PickupRadius + Capsule->GetScaledCapsuleRadius();
+
+		return Delta.SizeSquared2D() <= FMath::Square(Reach)
+			&& FMath::Abs(Delta.Z) <= PickupRadius + Capsule->GetScaledCapsuleHalfHeight();
+	}
+
+	return Delta.SizeSquared() <= FMath::Square(PickupRadius);
+}
@@ -3,17 +3,24 @@
 
 #include "Items/Soul.h"
 #include "Interfaces/PickupInterface.h"
+#include "Pooling/ActorPoolSubsystem.h"
+#include "Items/LootAggregationSubsystem.h"
+#include "OpenWorldRPG.h"
 
-void ASoul::OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+void ASoul::OnPickupRangeExited(IPickupInterface* Picker)
 {
-	IPickupInterface* PickupInterface = Cast<IPickupInterface>(OtherActor);
-	if (PickupInterface)
-	{
-		PickupInterface->AddSouls(this);
-		SpawnPickupSystem();
-		SpawnPickupSound();
+	RPG_SCOPE_CYCLE_COUNTER(Pickups);
 
-		Destroy();
+	// Batched with everything else collected this frame
+	if (ULootAggregationSubsystem* Loot = GetWorld()->GetSubsystem<ULootAggregationSubsystem>())
+	{
+		Loot->QueueCollection(Picker, this);
+		return;
 	}
-	
+
+	Picker->AddSouls(this);
+	SpawnPickupSystem();
+	SpawnPickupSound();
+
+	UActorPoolSubsystem::ReleaseOrDestroy(this);
 }
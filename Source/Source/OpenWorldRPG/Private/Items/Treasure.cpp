@@ -6,15 +6,30 @@
 #include "Kismet/KismetSystemLibrary.h"
 #include "Interfaces/PickupInterface.h"
 #include "Kismet/GameplayStatics.h"
+#include "Pooling/ActorPoolSubsystem.h"
+#include "Items/LootAggregationSubsystem.h"
+#include "OpenWorldRPG.h"
 
-void ATreasure::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void ATreasure::OnPickupRangeEntered(IPickupInterface* Picker)
 {
-	IPickupInterface* PickupInterface = Cast<IPickupInterface>(OtherActor);
-	if (PickupInterface)
-	{
-		PickupInterface->AddGold(this);
+	RPG_SCOPE_CYCLE_COUNTER(Pickups);
 
-		SpawnPickupSound();
-		Destroy();
+	// Batched with everything else collected this frame
+	if (ULootAggregationSubsystem* Loot = GetWorld()->GetSubsystem<ULootAggregationSubsystem>())
+	{
+		Loot->QueueCollection(Picker, this);
+		return;
 	}
+
+	Picker->AddGold(this);
+
+	SpawnPickupSound();
+	UActorPoolSubsystem::ReleaseOrDestroy(this);
+}
+
+void ATreasure::OnAcquiredFromPool()
+{
+	Super::OnAcquiredFromPool();
+
+	Gold = GetClass()->GetDefaultObject<ATreasure>()->Gold;
 }
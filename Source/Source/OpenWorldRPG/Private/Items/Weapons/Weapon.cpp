@@ -8,15 +8,21 @@
 #include "Components/SphereComponent.h"
 #include "Components/BoxComponent.h"
 #include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "DrawDebugHelpers.h"
 #include "NiagaraComponent.h"
-#include "Interfaces/HitInterface.h"
+#include "Spatial/SpatialHashSubsystem.h"
+#include "Combat/CombatResolutionSubsystem.h"
+#include "OpenWorldRPG.h"
 
 /*==============================
 	Constructor
 ==============================*/
 AWeapon::AWeapon()
 {
+	// Only ticks while a swing is being sampled
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
 	// Weapon hitbox
 	WeaponBox = CreateDefaultSubobject<UBoxComponent>(TEXT("Weapon Box"));
 	WeaponBox->SetupAttachment(GetRootComponent());
@@ -29,6 +35,9 @@ AWeapon::AWeapon()
 		ECollisionResponse::ECR_Ignore
 	);
 
+	// Hits come from the swing sweeps, the box no longer needs overlap events
+	WeaponBox->SetGenerateOverlapEvents(false);
+
 	// Trace start and end points
 	BoxTraceStart = CreateDefaultSubobject<USceneComponent>(TEXT("Box Trace Start"));
 	BoxTraceStart->SetupAttachment(GetRootComponent());
@@ -43,12 +52,32 @@ AWeapon::AWeapon()
 void AWeapon::BeginPlay()
 {
 	Super::BeginPlay();
+}
 
-	// Bind overlap event
-	WeaponBox->OnComponentBeginOverlap.AddDynamic(
-		this,
-		&AWeapon::OnBoxOverlap
-	);
+void AWeapon::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (bSwinging)
+	{
+		SampleSwing();
+	}
+}
+
+/*==============================
+	Pooling
+==============================*/
+void AWeapon::OnReleasedToPool()
+{
+	Super::OnReleasedToPool();
+
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	SetTickParent(nullptr);
+	SetOwner(nullptr);
+	SetInstigator(nullptr);
+
+	WeaponBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	EndSwing();
 }
 
 /*==============================
@@ -61,13 +90,20 @@ void AWeapon::Equip(
 	APawn* NewInstigator
 )
 {
-	// Update item state
-	ItemState = EItemState::EIS_Equipped;
+	// Update item state, which also stops the hover bob
+	SetItemState(EItemState::EIS_Equipped);
 
 	SetOwner(NewOwner);
 	SetInstigator(NewInstigator);
 
 	AttachMeshToSocket(InParent, InSocketName);
+
+	// Equipped weapons ride along with their owner and are no longer world items
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->UnregisterActor(this);
+	}
+
 	DisableSphereCollision();
 	PlayEquipSound();
 	DeactivateEmbers();
@@ -116,100 +152,243 @@ void AWeapon::AttachMeshToSocket(
 		TransformRules,
 		InSocketName
 	);
+
+	// Sample the blade after the owner's animation has posed it this frame
+	SetTickParent(InParent);
+}
+
+void AWeapon::SetTickParent(USceneComponent* NewParent)
+{
+	USceneComponent* OldParent = TickParent.Get();
+	if (OldParent == NewParent) return;
+
+	if (OldParent)
+	{
+		RemoveTickPrerequisiteComponent(OldParent);
+	}
+
+	if (NewParent)
+	{
+		AddTickPrerequisiteComponent(NewParent);
+	}
+
+	TickParent = NewParent;
 }
 
 /*==============================
-	Collision & Damage
+	Swing Window
 ==============================*/
-void AWeapon::OnBoxOverlap(
-	UPrimitiveComponent* OverlappedComponent,
-	AActor* OtherActor,
-	UPrimitiveComponent* OtherComp,
-	int32 OtherBodyIndex,
-	bool bFromSweep,
-	const FHitResult& SweepResult
-)
+void AWeapon::BeginSwing()
+{
+	bSwinging = true;
+	HitRegistry.Reset(this, GetOwner());
+	PendingHits.Reset();
+	SetActorTickEnabled(true);
+
+	// The first frame sweeps from where the blade is now
+	LastBladePose = GetBladePose();
+}
+
+void AWeapon::EndSwing()
 {
-	// Ignore friendly hits
-	if (ActorIsSameType(OtherActor))
+	bSwinging = false;
+	HitRegistry.Reset(this, GetOwner());
+	PendingHits.Reset();
+	SetActorTickEnabled(false);
+}
+
+AWeapon::FBladePose AWeapon::GetBladePose() const
+{
+	FBladePose Pose;
+	Pose.Start = BoxTraceStart->GetComponentLocation();
+	Pose.End = BoxTraceEnd->GetComponentLocation();
+	Pose.Rotation = BoxTraceStart->GetComponentQuat();
+	return Pose;
+}
+
+void AWeapon::SampleSwing()
+{
+	RPG_SCOPE_CYCLE_COUNTER(WeaponSweep);
+
+	const FBladePose CurrentPose = GetBladePose();
+
+	// Enough sub-steps that neither end of the blade skips more than SwingSubstepLength
+	const double Travel = FMath::Max(
+		FVector::Dist(CurrentPose.Start, LastBladePose.Start),
+		FVector::Dist(CurrentPose.End, LastBladePose.End));
+	const int32 NumSubsteps = FMath::Clamp(
+		FMath::CeilToInt32(Travel / SwingSubstepLength),
+		1,
+		MaxSwingSubsteps);
+
+	for (int32 Substep = 1; Substep <= NumSubsteps && !IsOutOfCleaveTargets(); ++Substep)
 	{
-		return;
+		const float Alpha = static_cast<float>(Substep) / NumSubsteps;
+
+		FBladePose Pose;
+		Pose.Start = FMath::Lerp(LastBladePose.Start, CurrentPose.Start, Alpha);
+		Pose.End = FMath::Lerp(LastBladePose.End, CurrentPose.End, Alpha);
+		Pose.Rotation = FQuat::Slerp(LastBladePose.Rotation, CurrentPose.Rotation, Alpha);
+
+		CollectHits(Pose);
 	}
 
-	FHitResult BoxHit;
-	BoxTrace(BoxHit);
+	LastBladePose = CurrentPose;
 
-	if (BoxHit.GetActor())
+	ApplySwingHits();
+}
+
+void AWeapon::CollectHits(const FBladePose& Pose)
+{
+	if (!bCleave)
 	{
-		// Ignore friendly hits again after trace
-		if (ActorIsSameType(BoxHit.GetActor()))
+		FHitResult BoxHit;
+		if (BoxTrace(Pose, BoxHit))
 		{
-			return;
+			QueueHit(BoxHit);
 		}
+		return;
+	}
 
-		// Apply damage
-		UGameplayStatics::ApplyDamage(
-			BoxHit.GetActor(),
-			Damage,
-			GetInstigator()->GetController(),
-			this,
-			UDamageType::StaticClass()
-		);
+	// One query finds the whole group the blade passes through
+	CleaveHits.Reset();
+	BoxTraceMulti(Pose, CleaveHits);
 
-		ExecuteGetHit(BoxHit);
-		CreateFields(BoxHit.ImpactPoint);
+	for (const FHitResult& BoxHit : CleaveHits)
+	{
+		if (IsOutOfCleaveTargets()) break;
+
+		QueueHit(BoxHit);
 	}
 }
 
-bool AWeapon::ActorIsSameType(AActor* OtherActor)
+void AWeapon::QueueHit(const FHitResult& BoxHit)
 {
-	return GetOwner()->ActorHasTag(TEXT("Enemy")) &&
-		OtherActor->ActorHasTag(TEXT("Enemy"));
+	AActor* HitActor = BoxHit.GetActor();
+	if (HitActor == nullptr || ActorIsSameType(HitActor)) return;
+
+	// Each actor is hit at most once per swing; registering also excludes it from later sweeps
+	const int32 TargetIndex = HitRegistry.Num();
+	if (!HitRegistry.Register(HitActor)) return;
+
+	FPendingHit& PendingHit = PendingHits.AddDefaulted_GetRef();
+	PendingHit.BoxHit = BoxHit;
+	PendingHit.Damage = bCleave
+		? Damage * FMath::Pow(1.f - CleaveFalloff, static_cast<float>(TargetIndex))
+		: Damage;
 }
 
-void AWeapon::ExecuteGetHit(FHitResult& BoxHit)
+void AWeapon::ApplySwingHits()
 {
-	IHitInterface* HitInterface = Cast<IHitInterface>(BoxHit.GetActor());
-	if (HitInterface)
+	UCombatResolutionSubsystem* CombatResolution = GetWorld()->GetSubsystem<UCombatResolutionSubsystem>();
+
+	for (FPendingHit& PendingHit : PendingHits)
 	{
-		HitInterface->Execute_GetHit(
-			BoxHit.GetActor(),
-			BoxHit.ImpactPoint,
-			GetOwner()
-		);
+		FHitResult& BoxHit = PendingHit.BoxHit;
+
+		// Earlier hits this frame may have destroyed or pooled the actor
+		if (!IsValid(BoxHit.GetActor())) continue;
+
+		FCombatHit Hit;
+		Hit.Victim = BoxHit.GetActor();
+		Hit.DamageCauser = this;
+		Hit.InstigatorController = GetInstigatorController();
+		Hit.Hitter = GetOwner();
+		Hit.ImpactPoint = BoxHit.ImpactPoint;
+		Hit.Damage = PendingHit.Damage;
+
+		// Damage and hit reacts resolve at the end of the frame, merged per victim
+		if (CombatResolution)
+		{
+			CombatResolution->QueueHit(Hit);
+		}
+		else
+		{
+			UCombatResolutionSubsystem::ResolveHit(Hit);
+		}
+
+		CreateFields(BoxHit.ImpactPoint);
 	}
+
+	PendingHits.Reset();
+}
+
+/*==============================
+	Collision & Damage
+==============================*/
+
+bool AWeapon::ActorIsSameType(AActor* OtherActor)
+{
+	return GetOwner()->ActorHasTag(TEXT("Enemy")) &&
+		OtherActor->ActorHasTag(TEXT("Enemy"));
 }
 
 /*==============================
 	Tracing
 ==============================*/
-void AWeapon::BoxTrace(FHitResult& BoxHit)
+bool AWeapon::BoxTrace(const FBladePose& Pose, FHitResult& BoxHit) const
 {
-	const FVector Start = BoxTraceStart->GetComponentLocation();
-	const FVector End = BoxTraceEnd->GetComponentLocation();
+	RPG_COUNTER_ADD(TracesIssued, 1);
 
-	TArray<AActor*> ActorsToIgnore;
-	ActorsToIgnore.Add(this);
-	ActorsToIgnore.Add(GetOwner());
+	// Visibility, the channel TraceTypeQuery1 maps to
+	const bool bHit = GetWorld()->SweepSingleByChannel(
+		BoxHit,
+		Pose.Start,
+		Pose.End,
+		Pose.Rotation,
+		ECollisionChannel::ECC_Visibility,
+		FCollisionShape::MakeBox(BoxTraceExtent),
+		HitRegistry.GetQueryParams()
+	);
 
-	for (AActor* Actor : IgnoreActors)
+	if (bShowBoxDebug)
 	{
-		ActorsToIgnore.AddUnique(Actor);
+		DrawDebugSweptBox(
+			GetWorld(),
+			Pose.Start,
+			Pose.End,
+			Pose.Rotation.Rotator(),
+			BoxTraceExtent,
+			bHit ? FColor::Green : FColor::Red,
+			false,
+			5.f
+		);
 	}
 
-	UKismetSystemLibrary::BoxTraceSingle(
-		this,
-		Start,
-		End,
-		BoxTraceExtent,
-		BoxTraceStart->GetComponentRotation(),
-		ETraceTypeQuery::TraceTypeQuery1,
-		false,
-		ActorsToIgnore,
-		bShowBoxDebug ? EDrawDebugTrace::ForDuration : EDrawDebugTrace::None,
-		BoxHit,
-		true
+	return bHit;
+}
+
+void AWeapon::BoxTraceMulti(const FBladePose& Pose, TArray<FHitResult>& OutHits) const
+{
+	RPG_COUNTER_ADD(TracesIssued, 1);
+
+	// An object query reports everything along the sweep instead of stopping at the first blocker
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Pawn);
+	ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_PhysicsBody);
+	ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Destructible);
+
+	GetWorld()->SweepMultiByObjectType(
+		OutHits,
+		Pose.Start,
+		Pose.End,
+		Pose.Rotation,
+		ObjectParams,
+		FCollisionShape::MakeBox(BoxTraceExtent),
+		HitRegistry.GetQueryParams()
 	);
 
-	IgnoreActors.AddUnique(BoxHit.GetActor());
+	if (bShowBoxDebug)
+	{
+		DrawDebugSweptBox(
+			GetWorld(),
+			Pose.Start,
+			Pose.End,
+			Pose.Rotation.Rotator(),
+			BoxTraceExtent,
+			OutHits.Num() > 0 ? FColor::Green : FColor::Red,
+			false,
+			5.f
+		);
+	}
 }
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+/*==============================
+	Includes
+==============================*/
+#include "Items/Weapons/WeaponHitRegistry.h"
+#include "GameFramework/Actor.h"
+
+/*==============================
+	Swing
+==============================*/
+void FWeaponHitRegistry::Reset(const AActor* Weapon, const AActor* Owner)
+{
+	HitActors.Reset();
+
+	QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(WeaponSwing), false, Weapon);
+	QueryParams.AddIgnoredActor(Owner);
+}
+
+bool FWeaponHitRegistry::Register(const AActor* Actor)
+{
+	if (Actor == nullptr || Contains(Actor))
+	{
+		return false;
+	}
+
+	HitActors.Add(Actor);
+	QueryParams.AddIgnoredActor(Actor);
+	return true;
+}
+
+bool FWeaponHitRegistry::Contains(const AActor* Actor) const
+{
+	return HitActors.Contains(TObjectKey<AActor>(Actor));
+}
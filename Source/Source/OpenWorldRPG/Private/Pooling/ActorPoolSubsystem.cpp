@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pooling/ActorPoolSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "OpenWorldRPG.h"
+
+// =======================
+// Pooling
+// =======================
+#include "Pooling/PoolSettings.h"
+#include "Interfaces/PoolableInterface.h"
+
+/* =====================================================
+ * Console Commands
+ * ===================================================== */
+
+static FAutoConsoleCommandWithWorld DumpActorPoolStatsCommand(
+	TEXT("rpg.Pool.Stats"),
+	TEXT("Logs hit/miss rates and free counts for every actor pool in the current world."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UActorPoolSubsystem* Pool = World ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr)
+		{
+			Pool->DumpStats();
+		}
+	}));
+
+/* =====================================================
+ * Acquire / Release
+ * ===================================================== */
+
+AActor* UActorPoolSubsystem::AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform)
+{
+	if (ActorClass == nullptr) return nullptr;
+
+	FActorPool& Pool = Pools.FindOrAdd(ActorClass.Get());
+	Pool.ActorClass = ActorClass.Get();
+
+	while (Pool.FreeActors.Num() > 0)
+	{
+		AActor* Actor = Pool.FreeActors.Pop(EAllowShrinking::No).Get();
+		Pool.Stats.NumFree = Pool.FreeActors.Num();
+		if (Actor == nullptr) continue;
+
+		++Pool.Stats.Hits;
+		ActivateActor(Actor, Transform);
+		return Actor;
+	}
+
+	++Pool.Stats.Misses;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	return GetWorld()->SpawnActor<AActor>(ActorClass, Transform, SpawnParams);
+}
+
+void UActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+	if (!IsValid(Actor)) return;
+
+	FActorPool& Pool = Pools.FindOrAdd(Actor->GetClass());
+	Pool.ActorClass = Actor->GetClass();
+
+	// Already parked, releasing twice must not hand it out twice
+	if (Pool.FreeActors.Contains(Actor)) return;
+
+	++Pool.Stats.Releases;
+
+	if (Pool.FreeActors.Num() >= GetDefault<UPoolSettings>()->MaxPooledActorsPerClass)
+	{
+		++Pool.Stats.Discards;
+		Actor->Destroy();
+		return;
+	}
+
+	DeactivateActor(Actor);
+	Pool.FreeActors.Add(Actor);
+	Pool.Stats.NumFree = Pool.FreeActors.Num();
+}
+
+void UActorPoolSubsystem::ReleaseOrDestroy(AActor* Actor)
+{
+	if (!IsValid(Actor)) return;
+
+	UWorld* World = Actor->GetWorld();
+	UActorPoolSubsystem* Pool = World && !World->bIsTearingDown ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr;
+
+	if (Pool)
+	{
+		Pool->ReleaseActor(Actor);
+	}
+	else
+	{
+		Actor->Destroy();
+	}
+}
+
+void UActorPoolSubsystem::WarmUp(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+	if (ActorClass == nullptr) return;
+
+	FActorPool& Pool = Pools.FindOrAdd(ActorClass.Get());
+	Pool.ActorClass = ActorClass.Get();
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// Parked out of sight until acquired
+	const FTransform ParkingTransform(FVector(0.f, 0.f, -100000.f));
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		if (AActor* Actor = GetWorld()->SpawnActor<AActor>(ActorClass, ParkingTransform, SpawnParams))
+		{
+			DeactivateActor(Actor);
+			Pool.FreeActors.Add(Actor);
+		}
+	}
+
+	Pool.Stats.NumFree = Pool.FreeActors.Num();
+}
+
+/* =====================================================
+ * Stats
+ * ===================================================== */
+
+const UActorPoolSubsystem::FPoolStats* UActorPoolSubsystem::GetStats(TSubclassOf<AActor> ActorClass) const
+{
+	const FActorPool* Pool = Pools.Find(ActorClass.Get());
+	return Pool ? &Pool->Stats : nullptr;
+}
+
+void UActorPoolSubsystem::DumpStats() const
+{
+	for (const TPair<TObjectKey<UClass>, FActorPool>& Pair : Pools)
+	{
+		const FActorPool& Pool = Pair.Value;
+		const UClass* ActorClass = Pool.ActorClass.Get();
+		const int32 Acquires = Pool.Stats.Hits + Pool.Stats.Misses;
+
+		UE_LOG(LogOpenWorldRPG, Display,
+			TEXT("ActorPool %-32s acquires %6d, hit rate %5.1f%%, releases %6d, discarded %4d, free %4d"),
+			ActorClass ? *ActorClass->GetName() : TEXT("<unloaded>"),
+			Acquires,
+			Acquires > 0 ? 100.0 * Pool.Stats.Hits / Acquires : 0.0,
+			Pool.Stats.Releases,
+			Pool.Stats.Discards,
+			Pool.Stats.NumFree);
+	}
+}
+
+/* =====================================================
+ * <UWorldSubsystem> Overrides
+ * ===================================================== */
+
+void UActorPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (const TPair<TSoftClassPtr<AActor>, int32>& WarmUpCount : GetDefault<UPoolSettings>()->ActorWarmUpCounts)
+	{
+		WarmUp(WarmUpCount.Key.LoadSynchronous(), WarmUpCount.Value);
+	}
+}
+
+bool UActorPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Activation
+ * ===================================================== */
+
+void UActorPoolSubsystem::DeactivateActor(AActor* Actor)
+{
+	if (IPoolableInterface* Poolable = Cast<IPoolableInterface>(Actor))
+	{
+		Poolable->OnReleasedToPool();
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+}
+
+void UActorPoolSubsystem::ActivateActor(AActor* Actor, const FTransform& Transform)
+{
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+
+	// Only actors that tick from the start get their tick back
+	const AActor* Defaults = Actor->GetClass()->GetDefaultObject<AActor>();
+	Actor->SetActorTickEnabled(Defaults->PrimaryActorTick.bStartWithTickEnabled);
+
+	if (IPoolableInterface* Poolable = Cast<IPoolableInterface>(Actor))
+	{
+		Poolable->OnAcquiredFromPool();
+	}
+}
@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Spatial/SpatialHashSubsystem.h"
+
+// =======================
+// Core / Engine
+// =======================
+#include "HAL/IConsoleManager.h"
+#include "GameFramework/Actor.h"
+
+/* =====================================================
+ * Console Variables
+ * ===================================================== */
+
+static TAutoConsoleVariable<float> CVarSpatialHashCellSize(
+	TEXT("rpg.SpatialHash.CellSize"),
+	1000.f,
+	TEXT("Edge length of a spatial hash cell in world units. Read when a world starts."),
+	ECVF_Default);
+
+/* =====================================================
+ * Registration
+ * ===================================================== */
+
+void USpatialHashSubsystem::RegisterActor(AActor* Actor, ESpatialCategory Category, bool bDynamic)
+{
+	if (Actor == nullptr || ActorToEntry.Contains(Actor)) return;
+
+	FSpatialEntry NewEntry;
+	NewEntry.Actor = Actor;
+	NewEntry.ActorKey = Actor;
+	NewEntry.Location = Actor->GetActorLocation();
+	NewEntry.Cell = GetCell(NewEntry.Location);
+	NewEntry.Category = Category;
+	NewEntry.bDynamic = bDynamic;
+
+	const int32 EntryIndex = Entries.Add(NewEntry);
+	ActorToEntry.Add(Actor, EntryIndex);
+	AddToCell(EntryIndex);
+
+	if (bDynamic)
+	{
+		Entries[EntryIndex].DynamicIndex = DynamicEntries.Add(EntryIndex);
+	}
+}
+
+void USpatialHashSubsystem::UnregisterActor(AActor* Actor)
+{
+	if (const int32* EntryIndex = ActorToEntry.Find(Actor))
+	{
+		RemoveEntry(*EntryIndex);
+	}
+}
+
+void USpatialHashSubsystem::UpdateActorLocation(AActor* Actor)
+{
+	const int32* EntryIndex = ActorToEntry.Find(Actor);
+	if (EntryIndex && Actor)
+	{
+		MoveEntry(*EntryIndex, Actor->GetActorLocation());
+	}
+}
+
+/* =====================================================
+ * Queries
+ * ===================================================== */
+
+void USpatialHashSubsystem::ForEachInRadius(
+	const FVector& Origin,
+	double Radius,
+	ESpatialCategory CategoryMask,
+	TFunctionRef<void(AActor* Actor, double DistSquared)> Visitor) const
+{
+	const double RadiusSquared = FMath::Square(Radius);
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius, Radius, 0.0));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius, Radius, 0.0));
+
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			const auto* Cell = Cells.Find(FIntPoint(CellX, CellY));
+			if (Cell == nullptr) continue;
+
+			for (const int32 EntryIndex : *Cell)
+			{
+				const FSpatialEntry& Entry = Entries[EntryIndex];
+				if (!EnumHasAnyFlags(Entry.Category, CategoryMask)) continue;
+
+				const double DistSquared = FVector::DistSquared(Origin, Entry.Location);
+				if (DistSquared > RadiusSquared) continue;
+
+				if (AActor* Actor = Entry.Actor.Get())
+				{
+					Visitor(Actor, DistSquared);
+				}
+			}
+		}
+	}
+}
+
+/* =====================================================
+ * <UTickableWorldSubsystem> Overrides
+ * ===================================================== */
+
+void USpatialHashSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	CellSize = FMath::Max(100.0, static_cast<double>(CVarSpatialHashCellSize.GetValueOnGameThread()));
+}
+
+void USpatialHashSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Backwards, so a swap-removed stale entry only pulls in one already visited
+	for (int32 DynamicIndex = DynamicEntries.Num() - 1; DynamicIndex >= 0; --DynamicIndex)
+	{
+		const int32 EntryIndex = DynamicEntries[DynamicIndex];
+
+		if (const AActor* Actor = Entries[EntryIndex].Actor.Get())
+		{
+			MoveEntry(EntryIndex, Actor->GetActorLocation());
+		}
+		else
+		{
+			// Garbage collected without unregistering
+			RemoveEntry(EntryIndex);
+		}
+	}
+}
+
+TStatId USpatialHashSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpatialHashSubsystem, STATGROUP_Tickables);
+}
+
+bool USpatialHashSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/* =====================================================
+ * Grid Storage
+ * ===================================================== */
+
+FIntPoint USpatialHashSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void USpatialHashSubsystem::AddToCell(int32 EntryIndex)
+{
+	Cells.FindOrAdd(Entries[EntryIndex].Cell).Add(EntryIndex);
+}
+
+void USpatialHashSubsystem::RemoveFromCell(int32 EntryIndex)
+{
+	const FIntPoint Cell = Entries[EntryIndex].Cell;
+
+	if (auto* CellEntries = Cells.Find(Cell))
+	{
+		CellEntries->RemoveSwap(EntryIndex);
+
+		if (CellEntries->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+void USpatialHashSubsystem::MoveEntry(int32 EntryIndex, const FVector& NewLocation)
+{
+	FSpatialEntry& Entry = Entries[EntryIndex];
+	Entry.Location = NewLocation;
+
+	const FIntPoint NewCell = GetCell(NewLocation);
+	if (NewCell == Entry.Cell) return;
+
+	RemoveFromCell(EntryIndex);
+	Entries[EntryIndex].Cell = NewCell;
+	AddToCell(EntryIndex);
+}
+
+void USpatialHashSubsystem::RemoveEntry(int32 EntryIndex)
+{
+	const FSpatialEntry& Entry = Entries[EntryIndex];
+
+	RemoveFromCell(EntryIndex);
+	ActorToEntry.Remove(Entry.ActorKey);
+
+	if (Entry.DynamicIndex != INDEX_NONE)
+	{
+		// Swap-remove, then repoint whichever entry moved into the hole
+		const int32 DynamicIndex = Entry.DynamicIndex;
+		DynamicEntries.RemoveAtSwap(DynamicIndex, 1, EAllowShrinking::No);
+
+		if (DynamicEntries.IsValidIndex(DynamicIndex))
+		{
+			Entries[DynamicEntries[DynamicIndex]].DynamicIndex = DynamicIndex;
+		}
+	}
+
+	Entries.RemoveAt(EntryIndex);
+}
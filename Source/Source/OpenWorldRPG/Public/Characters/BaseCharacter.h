@@ -11,6 +11,7 @@
 class AWeapon;
 class UAnimMontage;
 class UAttributeComponent;
+enum class ESpatialCategory : uint8;
 
 UCLASS()
 class OPENWORLDRPG_API ABaseCharacter : public ACharacter, public IHitInterface
@@ -25,6 +26,11 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Category this character is registered under in the spatial hash
+	virtual ESpatialCategory GetSpatialCategory() const;
+
 	virtual void GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter) override;
 	virtual void Attack();
 
@@ -47,6 +47,18 @@ enum class EEnemyState : uint8
 	EES_Patrolling UMETA(DisplayName = "Patrolling"),
 	EES_Chasing UMETA(DisplayName = "Chasing"),
 	EES_Attacking UMETA(DisplayName = "Attacking"),
-	EES_Engaged UMETA(DisplayName = "Engaged")
+	EES_Engaged UMETA(DisplayName = "Engaged"),
 
+	//kept last so the ordered checks against EES_Attacking never treat a waiter as idle
+	EES_WaitingForToken UMETA(DisplayName = "WaitingForToken")
+
+};
+
+//enemy AI level of detail, picked from distance to the nearest player
+UENUM(BlueprintType)
+enum class EEnemyAILOD : uint8
+{
+	EAL_Full UMETA(DisplayName = "Full"),
+	EAL_Reduced UMETA(DisplayName = "Reduced"),
+	EAL_Dormant UMETA(DisplayName = "Dormant")
 };
\ No newline at end of file
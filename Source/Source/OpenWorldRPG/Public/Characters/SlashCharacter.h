@@ -153,6 +153,7 @@ protected:
 	 * ===================================================== */
 
 	virtual void BeginPlay() override;
+	virtual ESpatialCategory GetSpatialCategory() const override;
 
 	/* =====================================================
 	 * Input Handling
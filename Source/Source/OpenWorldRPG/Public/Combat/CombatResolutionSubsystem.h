@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "CombatResolutionSubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AController;
+
+/**
+ * One weapon hit waiting to be resolved.
+ */
+struct FCombatHit
+{
+	TWeakObjectPtr<AActor> Victim;
+
+	// The weapon, passed to ApplyDamage
+	TWeakObjectPtr<AActor> DamageCauser;
+	TWeakObjectPtr<AController> InstigatorController;
+
+	// Whoever swung, passed to GetHit for the hit direction
+	TWeakObjectPtr<AActor> Hitter;
+
+	FVector ImpactPoint = FVector::ZeroVector;
+	float Damage = 0.f;
+
+	// How many hits were folded into this one
+	int32 NumMerged = 1;
+
+	// Victim unique ID in the high half, instigator's in the low half; set by QueueHit
+	uint64 SortKey = 0;
+};
+
+/**
+ * Collects weapon hits during the frame and resolves them together.
+ * Hits from the same instigator on the same victim are merged and their
+ * damage adds up, so every attacker is still credited for its own damage.
+ * Every entry's damage for a victim lands before GetHit runs, once, with
+ * the impact point and hitter of its last entry, so a victim struck twice
+ * in a frame restarts its hit react once and still dies to a later hit. Entries are sorted by victim then instigator unique ID
+ * before resolving, which keeps the outcome independent of tick order.
+ */
+UCLASS()
+class OPENWORLDRPG_API UCombatResolutionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Queue
+	 * ===================================================== */
+
+	void QueueHit(const FCombatHit& Hit);
+
+	// Applies damage then GetHit, as the weapon used to do inline
+	static void ResolveHit(const FCombatHit& Hit);
+
+	FORCEINLINE int32 GetNumQueued() const { return PendingHits.Num(); }
+
+	// Hits received and victims resolved in the last resolution pass
+	FORCEINLINE int32 GetLastNumHits() const { return LastNumHits; }
+	FORCEINLINE int32 GetLastNumVictims() const { return LastNumVictims; }
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	static void ApplyHitDamage(const FCombatHit& Hit);
+
+	// GetHit is where characters react or die, so it runs after all of a victim's damage
+	static void PlayHitReact(const FCombatHit& Hit);
+
+	// One entry per victim and instigator, unsorted until resolution
+	TArray<FCombatHit> PendingHits;
+	TMap<uint64, int32> KeyToPending;
+
+	// Swapped with PendingHits while resolving, so hits caused by resolution wait for next frame
+	TArray<FCombatHit> ResolvingHits;
+
+	int32 LastNumHits = 0;
+	int32 LastNumVictims = 0;
+};
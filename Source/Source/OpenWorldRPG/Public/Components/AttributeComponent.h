@@ -18,6 +18,8 @@ public:
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 	void RegenStamina(float DeltaTime);
+	// Back to full health and stamina, used when a pooled actor is reused
+	void ResetAttributes();
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
@@ -60,4 +62,5 @@ public:
 	FORCEINLINE int32 GetSouls() const { return Souls; }
 	FORCEINLINE float GetDodgeCost() const { return DodgeCost; }
 	FORCEINLINE float GetStamina() const { return Stamina; }
+	FORCEINLINE bool IsStaminaFull() const { return Stamina >= MaxStamina; }
 };
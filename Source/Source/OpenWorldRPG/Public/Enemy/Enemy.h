@@ -13,6 +13,7 @@
 #include "Interfaces/HitInterface.h"
 #include "Characters/BaseCharacter.h"
 #include "Characters/CharacterTypes.h"
+#include "Enemy/EnemyTimingWheel.h"
 
 #include "Enemy.generated.h"
 
@@ -24,6 +25,8 @@ class UPawnSensingComponent;
 class AAIController;
 class AWeapon;
 class ASoul;
+class APatrolRoute;
+enum class EEnemyRangeClass : uint8;
 
 /**
  * Enemy character class
@@ -56,6 +59,67 @@ public:
 		AActor* DamageCauser) override;
 	virtual void Destroyed() override;
 
+	/* =====================================================
+	 * AI Update
+	 * ===================================================== */
+
+	 // Runs one step of patrol/combat logic. Driven by UEnemyAISubsystem,
+	 // or by Tick when bUseAISubsystem is turned off
+	void UpdateEnemy(float DeltaTime);
+
+	// Applies an AI level of detail chosen by UEnemyAISubsystem
+	void SetAILOD(EEnemyAILOD NewLOD);
+
+	// Pushed by UEnemyAISubsystem's batched range kernel when CombatTarget
+	// crosses AttackRadius or CombatRadius
+	void OnCombatRangeChanged(EEnemyRangeClass NewRangeClass);
+
+	// Called by UEnemyAISubsystem's timing wheel when a patrol, attack or death delay is up
+	void OnAITimerFired(EEnemyTimer Kind);
+
+	/* =====================================================
+	 * Perception
+	 * ===================================================== */
+
+	 // Called by UEnemyPerceptionSubsystem when a pawn comes into view
+	UFUNCTION()
+	void PawnSeen(APawn* SeenPawn);
+
+	// Requests a fresh line-of-sight trace to CombatTarget and reads last frame's result.
+	// Targets inside AttackRadius, or waited on for a token, always count as seen
+	void RefreshCombatTargetSight();
+	bool HasLostSightOfCombatTarget() const;
+
+	/* =====================================================
+	 * Crowd
+	 * ===================================================== */
+
+	 // Hands a promoted crowd agent its route. Call between deferred spawn and FinishSpawning
+	void SetPatrolTargets(const TArray<AActor*>& NewPatrolTargets, AActor* NewPatrolTarget);
+
+	/* =====================================================
+	 * Flow Field
+	 * ===================================================== */
+
+	 // Called by UEnemyFlowFieldSubsystem when a chasing enemy leaves the field, resumes normal pathing
+	void OnFlowFieldLost();
+
+	/* =====================================================
+	 * Engagement
+	 * ===================================================== */
+
+	 // Called by UEnemyEngagementSubsystem when a waiting enemy's turn to attack comes up
+	void OnAttackTokenGranted();
+
+	/* =====================================================
+	 * Pooling
+	 * ===================================================== */
+
+	 // Called by UEnemyPoolSubsystem. Deactivating hides the enemy and removes it
+	 // from every AI service; activating resets it to a fresh patrolling enemy
+	void DeactivateForPool();
+	void ActivateFromPool(const FTransform& SpawnTransform);
+
 	/* =====================================================
 	 * IHitInterface
 	 * ===================================================== */
@@ -71,6 +135,7 @@ protected:
 	 * ===================================================== */
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	/* =====================================================
 	 * <ABaseCharacter> Overrides
@@ -90,6 +155,10 @@ protected:
 	UPROPERTY(BlueprintReadOnly)
 	EEnemyState EnemyState = EEnemyState::EES_Patrolling;
 
+	// Current AI level of detail
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly)
+	EEnemyAILOD AILOD = EEnemyAILOD::EAL_Full;
+
 private:
 
 	/* =====================================================
@@ -108,6 +177,9 @@ private:
 	void StartPatrolling();
 	void ChaseTarget();
 
+	// Every state change goes through here so UEnemyAISubsystem hears when combat starts or ends
+	void SetEnemyState(EEnemyState NewState);
+
 	bool IsOutsideCombatRadius();
 	bool IsOutsideAttackRadius();
 	bool IsInsideAttackRadius();
@@ -117,10 +189,31 @@ private:
 	bool IsDead();
 	bool IsEngaged();
 
+	void EnterDormantLOD();
+	void ExitDormantLOD();
+
+	void RegisterWithAIServices();
+	void UnregisterFromAIServices();
+
+	// Resets health, state, collision and animation left over from a previous life
+	void ResetForReuse();
+
+	// Hands the corpse back to the pool, or destroys it when there is no pool
+	void DeathLifeSpanExpired();
+
+	// Timers run on UEnemyAISubsystem's timing wheel; arming replaces a pending one
+	void ArmAITimer(FEnemyTimerHandle& Handle, EEnemyTimer Kind, float DelaySeconds);
+	void CancelAITimer(FEnemyTimerHandle& Handle);
+
 	void ClearPatrolTimer();
 	void StartAttackTimer();
 	void ClearAttackTimer();
 
+	// Attack tokens from UEnemyEngagementSubsystem. Without one the enemy waits, circling its target
+	bool RequestAttackToken();
+	void ReleaseAttackToken();
+	void WaitForAttackToken();
+
 	void SpawnDefaultWeapon();
 	void SpawnSoul();
 
@@ -129,16 +222,10 @@ private:
 	 * ===================================================== */
 
 	void MoveToTarget(AActor* Target);
+	void CancelPathRequests();
 	bool InTargetRange(AActor* Target, double Radius);
 	AActor* ChoosePatrolTarget();
-
-	/* =====================================================
-	 * Pawn Sensing
-	 * ===================================================== */
-
-	 // Callback bound to UPawnSensingComponent::OnSeePawn
-	UFUNCTION()
-	void PawnSeen(APawn* SeenPawn);
+	AActor* ChooseFirstPatrolTarget();
 
 	/* =====================================================
 	 * Components
@@ -147,6 +234,7 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	UHealthBarComponent* HealthBarWidget;
 
+	// Sight settings read by UEnemyPerceptionSubsystem, never polls on its own
 	UPROPERTY(VisibleAnywhere)
 	UPawnSensingComponent* PawnSensing;
 
@@ -173,6 +261,20 @@ private:
 	UPROPERTY(EditAnywhere, Category = Combat)
 	double AcceptanceRadius = 75.f;
 
+	// Seconds without line of sight before giving up on a target inside CombatRadius
+	UPROPERTY(EditAnywhere, Category = Combat)
+	float LoseSightTime = 3.f;
+
+	// World time CombatTarget was last known to be visible
+	double LastCombatTargetSeenTime = 0.0;
+
+	// Range changes arrive from the AI subsystem, so the full combat check
+	// in UpdateEnemy only needs to run this often
+	UPROPERTY(EditAnywhere, Category = Combat)
+	float CombatRecheckInterval = 0.5f;
+
+	double LastCombatCheckTime = 0.0;
+
 	/* =====================================================
 	 * AI Navigation
 	 * ===================================================== */
@@ -185,16 +287,30 @@ private:
 	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
 	AActor* PatrolTarget;
 
-	// All possible patrol targets
+	// All possible patrol targets, used when no PatrolRoute is set
 	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
 	TArray<AActor*> PatrolTargets;
 
+	// Shared route this enemy walks, takes priority over PatrolTargets
+	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
+	APatrolRoute* PatrolRoute;
+
+	// Index of PatrolTarget on PatrolRoute
+	int32 PatrolWaypointIndex = INDEX_NONE;
+
 	// Max distance considered "at patrol target"
 	UPROPERTY(EditAnywhere)
 	double PatrolRadius = 200.f;
 
+	// When true the AI subsystem schedules this enemy and actor Tick stays off
+	UPROPERTY(EditAnywhere, Category = "AI Navigation")
+	bool bUseAISubsystem = true;
+
 	// Patrol timing
-	FTimerHandle PatrolTimer;
+	FEnemyTimerHandle PatrolTimer;
+
+	// Patrol wait left when the enemy went dormant, re-armed when it wakes
+	float PausedPatrolWait = 0.f;
 
 	UPROPERTY(EditAnywhere, Category = "AI Navigation")
 	float PatrolWaitMin = 5.f;
@@ -209,7 +325,7 @@ private:
 	 * Combat Timing
 	 * ===================================================== */
 
-	FTimerHandle AttackTimer;
+	FEnemyTimerHandle AttackTimer;
 
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	float AttackMin = 0.5f;
@@ -223,6 +339,14 @@ private:
 	UPROPERTY(EditAnywhere, Category = Combat)
 	float DeathLifeSpan = 8.f;
 
+	FEnemyTimerHandle DeathTimer;
+
+	// Parked in UEnemyPoolSubsystem, hidden and inactive
+	bool bInPool = false;
+
+	// In attack range but every attack token on the target is taken
+	bool bWaitingForAttackToken = false;
+
 	/* =====================================================
 	 * Debug
 	 * ===================================================== */
@@ -231,4 +355,24 @@ private:
 	bool bShowCombatRadius = false;
 
 	void ShowCombatRadius();
+
+	// Sensing interval authored on PawnSensing, restored at full LOD
+	float DefaultSensingInterval = 0.5f;
+
+public:
+
+	FORCEINLINE EEnemyState GetEnemyState() const { return EnemyState; }
+	FORCEINLINE EEnemyAILOD GetAILOD() const { return AILOD; }
+	FORCEINLINE bool IsInPool() const { return bInPool; }
+	FORCEINLINE bool IsWaitingForAttackToken() const { return bWaitingForAttackToken; }
+	FORCEINLINE AActor* GetCombatTarget() const { return CombatTarget; }
+	FORCEINLINE double GetCombatRadius() const { return CombatRadius; }
+	FORCEINLINE double GetAttackRadius() const { return AttackRadius; }
+	FORCEINLINE double GetPatrolRadius() const { return PatrolRadius; }
+	FORCEINLINE AActor* GetPatrolTarget() const { return PatrolTarget; }
+	FORCEINLINE float GetPatrolWaitMin() const { return PatrolWaitMin; }
+	FORCEINLINE float GetPatrolWaitMax() const { return PatrolWaitMax; }
+	FORCEINLINE float GetPatrollingSpeed() const { return PatrollingSpeed; }
+	FORCEINLINE float GetChasingSpeed() const { return ChasingSpeed; }
+	FORCEINLINE UPawnSensingComponent* GetPawnSensing() const { return PawnSensing; }
 };
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "Characters/CharacterTypes.h"
+#include "Enemy/EnemyStateStore.h"
+#include "Enemy/EnemyTimingWheel.h"
+
+#include "EnemyAISubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+
+/**
+ * World subsystem that owns every live AEnemy and drives their AI.
+ * Enemies are updated round-robin in batches, bounded by a per-frame
+ * time budget, instead of each actor ticking on its own.
+ *
+ * Each enemy also gets an AI level of detail from its distance to the
+ * nearest SlashCharacter: full rate, reduced rate, or dormant.
+ *
+ * Range decisions for enemies in combat are batched: positions, targets
+ * and radii are mirrored into an FEnemyStateStore, classified by a SIMD
+ * kernel, and only enemies whose range class changed are notified.
+ *
+ * Patrol waits, attack delays and death clean-up run on a timing wheel
+ * here rather than on the world timer manager, since enemies arm and
+ * cancel them constantly.
+ */
+UCLASS()
+class OPENWORLDRPG_API UEnemyAISubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Registration
+	 * ===================================================== */
+
+	void RegisterEnemy(AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	// Called by AEnemy when its state crosses into or out of combat
+	void SetEnemyInCombat(AEnemy* Enemy, bool bInCombat);
+
+	FORCEINLINE int32 GetNumEnemies() const { return Entries.Num(); }
+
+	/* =====================================================
+	 * Timers
+	 * ===================================================== */
+
+	 // Calls AEnemy::OnAITimerFired with Kind once DelaySeconds of game time have passed
+	FEnemyTimerHandle ArmTimer(AEnemy* Enemy, EEnemyTimer Kind, float DelaySeconds);
+	void CancelTimer(FEnemyTimerHandle& Handle);
+	float GetTimerRemaining(const FEnemyTimerHandle& Handle) const;
+
+	// Arm, cancel and fire counts from the last frame
+	FORCEINLINE const FEnemyTimingWheel::FChurn& GetLastFrameTimerChurn() const { return LastFrameTimerChurn; }
+	FORCEINLINE int32 GetNumPendingTimers() const { return TimingWheel.GetNumPending(); }
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	/* =====================================================
+	 * Scheduling
+	 * ===================================================== */
+
+	struct FEnemyAIEntry
+	{
+		TWeakObjectPtr<AEnemy> Enemy;
+
+		// World time of this enemy's last AI update
+		double LastUpdateTime = 0.0;
+
+		// World time of this enemy's last LOD evaluation
+		double LastLODCheckTime = 0.0;
+
+		EEnemyAILOD LOD = EEnemyAILOD::EAL_Full;
+
+		// Slot in StateStore, stable for the entry's lifetime
+		int32 StoreSlot = INDEX_NONE;
+	};
+
+	// Drops entries whose enemy unregistered or was garbage collected
+	void CompactEntries();
+
+	/* =====================================================
+	 * Level of Detail
+	 * ===================================================== */
+
+	void RefreshPlayerLocations();
+	double GetDistSquaredToNearestPlayer(const FVector& Location) const;
+	EEnemyAILOD ComputeLOD(const AEnemy* Enemy, EEnemyAILOD CurrentLOD) const;
+
+	// Whether the entry's LOD wants a full AI update this frame
+	bool IsUpdateDue(const FEnemyAIEntry& Entry, double Now) const;
+
+	// Locations of every SlashCharacter, refreshed once per frame
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+
+	/* =====================================================
+	 * Batched Range Checks
+	 * ===================================================== */
+
+	 // Mirrors the store's combat slots, runs the range kernel and notifies changes
+	void UpdateCombatRanges();
+
+	FEnemyStateStore StateStore;
+
+	TArray<FEnemyAIEntry> Entries;
+
+	// Index into Entries per registered enemy, kept in step by CompactEntries
+	TMap<TObjectKey<AEnemy>, int32> EntryIndices;
+
+	// Round-robin cursor, the first entry to update next frame
+	int32 NextEntryIndex = 0;
+
+	bool bHasStaleEntries = false;
+
+	/* =====================================================
+	 * Timers
+	 * ===================================================== */
+
+	 // Fires due timers and records this frame's churn
+	void AdvanceTimers(float DeltaTime);
+
+	FEnemyTimingWheel TimingWheel;
+
+	// Reused every frame for the timers that came due
+	TArray<FEnemyTimingWheel::FFiredTimer> FiredTimers;
+
+	FEnemyTimingWheel::FChurn LastFrameTimerChurn;
+};
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+class USpatialHashSubsystem;
+
+/**
+ * Reciprocal local avoidance for crowds of enemies closing on one target.
+ * Each agent bends its desired velocity away from neighbours it would
+ * otherwise touch within a short time horizon, taking half the
+ * responsibility as in RVO, plus a separation push for overlapping ones.
+ * Neighbours come from the spatial hash, so cost grows with local density
+ * rather than crowd size.
+ */
+class OPENWORLDRPG_API FEnemyAvoidance
+{
+public:
+
+	struct FAgent
+	{
+		AEnemy* Enemy = nullptr;
+		FVector Location = FVector::ZeroVector;
+		FVector DesiredVelocity = FVector::ZeroVector;
+		float Radius = 0.f;
+		float MaxSpeed = 0.f;
+	};
+
+	// Steering velocity per agent, same order. Only reads the world, so
+	// every agent sees the others as they were before anyone moved
+	static void ComputeSteering(
+		const USpatialHashSubsystem& SpatialHash,
+		TArrayView<const FAgent> Agents,
+		TArray<FVector>& OutVelocities);
+};
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+
+#include "EnemyCrowdSpawner.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class UInstancedStaticMeshComponent;
+class AEnemy;
+
+/**
+ * Places a crowd of background enemies around itself.
+ * The crowd is simulated by UEnemyCrowdSubsystem and drawn with one
+ * instanced static mesh; only agents near a player become real AEnemy actors.
+ */
+UCLASS()
+class OPENWORLDRPG_API AEnemyCrowdSpawner : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Constructor
+	 * ===================================================== */
+
+	AEnemyCrowdSpawner();
+
+protected:
+
+	/* =====================================================
+	 * <Actor> Overrides
+	 * ===================================================== */
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+	// Random reachable points within SpawnRadius, or plain disc points without a nav mesh
+	void GenerateSpawnLocations(TArray<FVector>& OutLocations) const;
+
+	/* =====================================================
+	 * Components
+	 * ===================================================== */
+
+	 // Stand-in mesh for every agent that isn't promoted to a real enemy
+	UPROPERTY(VisibleAnywhere)
+	UInstancedStaticMeshComponent* CrowdMesh;
+
+	/* =====================================================
+	 * Crowd
+	 * ===================================================== */
+
+	 // Spawned when an agent is promoted, also supplies speeds and radii
+	UPROPERTY(EditAnywhere, Category = Crowd)
+	TSubclassOf<AEnemy> EnemyClass;
+
+	UPROPERTY(EditAnywhere, Category = Crowd, meta = (ClampMin = "0"))
+	int32 NumAgents = 1000;
+
+	UPROPERTY(EditAnywhere, Category = Crowd)
+	float SpawnRadius = 5000.f;
+
+	// Character meshes usually face +Y, so the crowd mesh is turned to match
+	UPROPERTY(EditAnywhere, Category = Crowd)
+	float MeshYawOffset = -90.f;
+
+	// Shared by every agent in this crowd
+	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
+	TArray<AActor*> PatrolTargets;
+
+public:
+
+	FORCEINLINE UInstancedStaticMeshComponent* GetCrowdMesh() const { return CrowdMesh; }
+	FORCEINLINE TSubclassOf<AEnemy> GetEnemyClass() const { return EnemyClass; }
+	FORCEINLINE float GetMeshYawOffset() const { return MeshYawOffset; }
+	FORCEINLINE const TArray<AActor*>& GetPatrolTargets() const { return PatrolTargets; }
+};
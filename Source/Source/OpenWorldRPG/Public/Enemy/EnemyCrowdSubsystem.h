@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Characters/CharacterTypes.h"
+
+#include "EnemyCrowdSubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+class AEnemyCrowdSpawner;
+class APawn;
+
+/**
+ * Lightweight simulation for large crowds of background enemies.
+ * Each agent is a few values in structure-of-arrays groups, one group per
+ * AEnemyCrowdSpawner, and is drawn through that spawner's instanced mesh.
+ *
+ * Agents run the same patrol/chase states as AEnemy (EEnemyState). When a
+ * player comes within CombatRadius an agent is promoted to a real AEnemy,
+ * and once that enemy is back on patrol with every player out of range it
+ * is demoted to an agent again.
+ */
+UCLASS()
+class OPENWORLDRPG_API UEnemyCrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Registration
+	 * ===================================================== */
+
+	 // Adds one agent per spawn location, in the same order as the spawner's mesh instances
+	void RegisterSpawner(AEnemyCrowdSpawner* Spawner, const TArray<FVector>& SpawnLocations);
+	void UnregisterSpawner(AEnemyCrowdSpawner* Spawner);
+
+	int32 GetNumAgents() const;
+	FORCEINLINE int32 GetNumPromoted() const { return NumPromoted; }
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	/* =====================================================
+	 * Agents
+	 * ===================================================== */
+
+	struct FCrowdGroup
+	{
+		TWeakObjectPtr<AEnemyCrowdSpawner> Spawner;
+		TSubclassOf<AEnemy> EnemyClass;
+
+		// Copied from the enemy class defaults so the simulation never reads the CDO
+		float PatrollingSpeed = 125.f;
+		float ChasingSpeed = 300.f;
+		float PatrolWaitMin = 5.f;
+		float PatrolWaitMax = 10.f;
+		double SightRadius = 1000.0;
+		double CombatRadius = 1000.0;
+		double PatrolRadius = 200.0;
+
+		// Agents stand on the ground, promoted enemies spawn at capsule height
+		float SpawnHeight = 0.f;
+
+		TArray<FVector> PatrolPoints;
+
+		// One element per agent
+		TArray<FVector> Positions;
+		TArray<float> Yaws;
+		TArray<EEnemyState> States;
+		TArray<int32> PatrolIndices;
+		TArray<double> WaitUntil;
+		TArray<uint8> IsPromoted;
+		TArray<TWeakObjectPtr<AEnemy>> PromotedEnemies;
+
+		// Set when an agent moved, turned or was shown or hidden since the last push
+		TArray<uint8> IsDirty;
+
+		// Reused for each run of dirty agents in the instanced mesh update
+		TArray<FTransform> InstanceTransforms;
+	};
+
+	// Moves one simulated agent through the patrol/chase states
+	void SimulateAgent(
+		FCrowdGroup& Group,
+		int32 Agent,
+		int32 NearestPlayer,
+		double DistSquared,
+		float DeltaTime,
+		double Now);
+	void ChooseNextPatrolPoint(FCrowdGroup& Group, int32 Agent);
+
+	void PromoteAgent(FCrowdGroup& Group, int32 Agent, APawn* NearestPlayer);
+
+	// Demotes a promoted agent whose enemy has calmed down, or retires it if the enemy died
+	void UpdatePromotedAgent(FCrowdGroup& Group, int32 Agent, double Now);
+
+	// Sends only the runs of dirty agents to the instanced mesh, then marks it dirty once
+	void PushInstanceTransforms(FCrowdGroup& Group);
+
+	TArray<FCrowdGroup> Groups;
+
+	int32 NumPromoted = 0;
+
+	FRandomStream Random;
+
+	/* =====================================================
+	 * Players
+	 * ===================================================== */
+
+	void RefreshPlayers();
+
+	// Index into Players of the closest one, INDEX_NONE when there are none
+	int32 FindNearestPlayer(const FVector& Location, double& OutDistSquared) const;
+
+	TArray<TWeakObjectPtr<APawn>, TInlineAllocator<4>> Players;
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+};
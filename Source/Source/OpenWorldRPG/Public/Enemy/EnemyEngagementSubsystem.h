@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "Enemy/EnemyAvoidance.h"
+
+#include "EnemyEngagementSubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+
+/**
+ * Caps how many enemies attack one target at a time.
+ * An enemy in attack range asks for one of the target's attack tokens;
+ * without one it waits, circling the target at walking pace and reduced
+ * AI LOD. Released tokens go to the longest-waiting enemy first, so the
+ * number of swinging weapons stays bounded however large the crowd.
+ */
+UCLASS()
+class OPENWORLDRPG_API UEnemyEngagementSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Tokens
+	 * ===================================================== */
+
+	 // True if Enemy holds or was just given one of Target's tokens; otherwise queues it as a waiter
+	bool RequestToken(AEnemy* Enemy, AActor* Target);
+
+	// Gives up Enemy's token or place in the queue, whichever it has
+	void ReleaseToken(AEnemy* Enemy);
+
+	// Waiters further than this from their target give up their place and chase
+	static double GetWaitRadius(double AttackRadius);
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	struct FEngagement
+	{
+		TArray<TWeakObjectPtr<AEnemy>, TInlineAllocator<4>> Holders;
+
+		// Oldest first
+		TArray<TWeakObjectPtr<AEnemy>> Waiters;
+	};
+
+	// Drops holders and waiters that stopped fighting Target and hands freed tokens on
+	void RefreshEngagement(TObjectKey<AActor> TargetKey, FEngagement& Engagement);
+	void GrantWaitingTokens(FEngagement& Engagement);
+
+	// Tells newly granted enemies, once the token lists are consistent again
+	void NotifyGranted();
+
+	// Circles waiters around their target, batched through FEnemyAvoidance
+	void SteerWaiters();
+
+	TMap<TObjectKey<AActor>, FEngagement> Engagements;
+
+	// Which target each holder or waiter is queued on
+	TMap<TWeakObjectPtr<AEnemy>, TObjectKey<AActor>> EnemyTargets;
+
+	TArray<TWeakObjectPtr<AEnemy>> NewlyGranted;
+
+	// Reused every frame for the batched avoidance step
+	TArray<FEnemyAvoidance::FAgent> AvoidanceAgents;
+	TArray<FVector> SteeringVelocities;
+};
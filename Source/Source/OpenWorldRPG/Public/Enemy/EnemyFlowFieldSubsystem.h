@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "Enemy/EnemyAvoidance.h"
+
+#include "EnemyFlowFieldSubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+class APawn;
+
+/**
+ * Flow field toward the player for enemies chasing them.
+ * A square grid follows the player. Each cell's walkability is found by
+ * projecting onto the navmesh, a few hundred cells per frame on the game
+ * thread, and cached so moving the grid only samples newly uncovered cells.
+ * The integration and direction fields are built on a worker task into a
+ * back buffer and swapped in when done.
+ * Chasing enemies are steered along the field every frame instead of each
+ * running its own path query; outside the field they fall back to pathing.
+ * Their steering goes through FEnemyAvoidance so the pack spreads around
+ * the player instead of piling into one capsule stack.
+ */
+UCLASS()
+class OPENWORLDRPG_API UEnemyFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Followers
+	 * ===================================================== */
+
+	 // Whether the current field leads to Goal and covers Location
+	bool CanGuide(const AActor* Goal, const FVector& Location) const;
+
+	// Steers the enemy along the field while it keeps chasing the field's target
+	void AddFollower(AEnemy* Enemy);
+
+	// Unit direction toward the field's target at Location, false if outside the field or unreachable
+	bool SampleDirection(const FVector& Location, FVector& OutDirection) const;
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	/* =====================================================
+	 * Field Data
+	 * ===================================================== */
+
+	struct FFlowField
+	{
+		// World cell of the grid's minimum corner
+		FIntPoint Origin = FIntPoint::ZeroValue;
+		int32 Size = 0;
+		double CellSize = 100.0;
+
+		FIntPoint TargetCell = FIntPoint::ZeroValue;
+
+		// Per cell, row-major
+		TArray<uint8> Costs;
+		TArray<float> Integration;
+		TArray<FVector2f> Directions;
+
+		FORCEINLINE bool Contains(const FIntPoint& Local) const
+		{
+			return Local.X >= 0 && Local.Y >= 0 && Local.X < Size && Local.Y < Size;
+		}
+
+		FORCEINLINE int32 ToIndex(const FIntPoint& Local) const { return Local.Y * Size + Local.X; }
+	};
+
+	// Dijkstra from the target cell, then each cell points at its cheapest neighbour. Runs on a worker
+	static void BuildField(FFlowField& Field);
+
+	static FIntPoint GetCell(const FVector& Location, double CellSize);
+
+	/* =====================================================
+	 * Incremental Rebuild
+	 * ===================================================== */
+
+	 // Picks the player to lead to and moves the grid when they near its edge
+	void UpdateWindow();
+
+	// Projects up to the per-frame budget of unsampled window cells onto the navmesh
+	void SampleCosts();
+
+	void TryStartBuild(double Now);
+	void TryFinishBuild();
+
+	// Drops cached costs outside the current window so the cache stays window sized
+	void TrimCostCache();
+
+	// Cost cache key, the window's height band keeps stacked floors apart
+	FORCEINLINE FIntVector GetCostKey(const FIntPoint& Cell) const { return FIntVector(Cell.X, Cell.Y, WindowBand); }
+
+	TWeakObjectPtr<APawn> Target;
+
+	FIntPoint WindowOrigin = FIntPoint::ZeroValue;
+	int32 WindowSize = 0;
+	double WindowCellSize = 100.0;
+	float WindowHeight = 0.f;
+	int32 WindowBand = 0;
+	bool bHasWindow = false;
+
+	// Next window cell to check for a cached cost
+	int32 SampleCursor = 0;
+
+	// Walkability per world cell and height band, trimmed to the window whenever it moves
+	TMap<FIntVector, uint8> CostCache;
+
+	// Read by the game thread
+	TSharedPtr<FFlowField> FrontField;
+
+	// Owned by the worker while BuildTask runs
+	TSharedPtr<FFlowField> BackField;
+
+	UE::Tasks::TTask<void> BuildTask;
+	bool bBuildInFlight = false;
+
+	// Who the in-flight build leads to, a finished build for anyone else is thrown away
+	TWeakObjectPtr<APawn> BuildTarget;
+
+	double LastBuildTime = 0.0;
+	FIntPoint LastBuildTargetCell = FIntPoint(MAX_int32, MAX_int32);
+	FIntPoint LastBuildOrigin = FIntPoint(MAX_int32, MAX_int32);
+
+	/* =====================================================
+	 * Steering
+	 * ===================================================== */
+
+	void SteerFollowers();
+
+	TArray<TWeakObjectPtr<AEnemy>> Followers;
+
+	// Reused every frame for the batched avoidance step
+	TArray<FEnemyAvoidance::FAgent> AvoidanceAgents;
+	TArray<FVector> SteeringVelocities;
+};
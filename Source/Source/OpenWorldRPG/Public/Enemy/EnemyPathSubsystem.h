@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "NavigationSystemTypes.h"
+
+#include "EnemyPathSubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+
+/**
+ * Schedules enemy move requests instead of pathfinding on the spot.
+ * Requests are queued per enemy (a newer request replaces an older one),
+ * run as async navmesh queries under a per-frame budget, and enemies
+ * heading for the same goal from nearby share one query. Recent paths to
+ * pawns are cached so a pack chasing the player reuses a single search.
+ */
+UCLASS()
+class OPENWORLDRPG_API UEnemyPathSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Requests
+	 * ===================================================== */
+
+	 // Queues a move to Goal. The move starts once a path is found, usually a frame or two later
+	void RequestMove(AEnemy* Enemy, AActor* Goal, float AcceptanceRadius);
+
+	// Drops anything queued or in flight for the enemy, e.g. when it dies
+	void CancelRequests(AEnemy* Enemy);
+
+	FORCEINLINE int32 GetNumQueued() const { return QueuedRequests.Num(); }
+	FORCEINLINE int32 GetNumInFlight() const { return InFlightQueries.Num(); }
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	/* =====================================================
+	 * Queue
+	 * ===================================================== */
+
+	struct FPathRequest
+	{
+		TWeakObjectPtr<AEnemy> Enemy;
+		TWeakObjectPtr<AActor> Goal;
+		float AcceptanceRadius = 0.f;
+
+		// Matches LatestSerials while this is the enemy's newest request
+		uint32 Serial = 0;
+	};
+
+	bool IsCurrent(const FPathRequest& Request) const;
+
+	// Issues an async query for the request, false if it could not be started
+	bool IssueQuery(const FPathRequest& Request);
+
+	// Joins an in-flight query to the same goal from close by, if there is one
+	bool JoinInFlightQuery(const FPathRequest& Request);
+
+	// Async query callback, runs on the game thread
+	void OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	// Starts the move along Path. bShared paths are copied and re-anchored at the enemy first
+	void ApplyPath(const FPathRequest& Request, const FNavPathSharedPtr& Path, bool bShared);
+
+	// Oldest first, may hold superseded requests which are skipped
+	TArray<FPathRequest> QueuedRequests;
+
+	TMap<TObjectKey<AEnemy>, uint32> LatestSerials;
+
+	uint32 NextSerial = 1;
+
+	struct FPathQuery
+	{
+		TWeakObjectPtr<AActor> Goal;
+		FVector Start = FVector::ZeroVector;
+
+		// The request that issued the query first, then any that joined it
+		TArray<FPathRequest, TInlineAllocator<4>> Requests;
+	};
+
+	TMap<uint32, FPathQuery> InFlightQueries;
+
+	/* =====================================================
+	 * Shared Path Cache
+	 * ===================================================== */
+
+	struct FCachedPath
+	{
+		FNavPathSharedPtr Path;
+		FVector Start = FVector::ZeroVector;
+		double Time = 0.0;
+	};
+
+	// Recent path to Goal starting close to Location, or null
+	FNavPathSharedPtr FindCachedPath(const AActor* Goal, const FVector& Location, double Now) const;
+
+	void AddCachedPath(const AActor* Goal, const FNavPathSharedPtr& Path, double Now);
+	void PruneCache(double Now);
+
+	TMap<TObjectKey<AActor>, TArray<FCachedPath, TInlineAllocator<4>>> PathCache;
+
+	double LastPruneTime = 0.0;
+};
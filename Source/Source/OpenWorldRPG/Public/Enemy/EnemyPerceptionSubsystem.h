@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "WorldCollision.h"
+
+#include "EnemyPerceptionSubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+class APawn;
+
+/**
+ * Shared sight service for every enemy.
+ * Candidates come from the spatial hash, all sight traces for a frame are
+ * issued as one async batch and read back on a later frame, and
+ * AEnemy::PawnSeen fires when a target becomes visible, and again on each
+ * sensing pass while it stays visible to a patrolling enemy. Cost follows
+ * the number of nearby observer/target pairs.
+ * Each enemy's UPawnSensingComponent only supplies radius, angle and interval.
+ */
+UCLASS()
+class OPENWORLDRPG_API UEnemyPerceptionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Registration
+	 * ===================================================== */
+
+	void RegisterObserver(AEnemy* Enemy);
+	void UnregisterObserver(AEnemy* Enemy);
+
+	// Forgets what an enemy currently sees, so targets in view are reported again
+	void ResetObserver(AEnemy* Enemy);
+
+	/* =====================================================
+	 * Line of Sight Queries
+	 * ===================================================== */
+
+	 // Queues an Observer -> Target visibility trace. Requests are deduplicated,
+	 // traced asynchronously, and their result lands in the cache a frame later
+	void RequestLineOfSight(AActor* Observer, AActor* Target);
+
+	// Last traced visibility for the pair. Returns false if it was never traced
+	bool GetCachedLineOfSight(
+		const AActor* Observer,
+		const AActor* Target,
+		bool& bOutVisible,
+		double& OutResultTime) const;
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	/* =====================================================
+	 * Observers
+	 * ===================================================== */
+
+	struct FPerceptionObserver
+	{
+		TWeakObjectPtr<AEnemy> Enemy;
+
+		// World time this observer is next allowed to look
+		double NextSenseTime = 0.0;
+
+		// Targets visible as of the last completed sight pass
+		TArray<TWeakObjectPtr<APawn>, TInlineAllocator<2>> VisibleTargets;
+	};
+
+	FPerceptionObserver* FindObserver(const AEnemy* Enemy);
+	void RebuildObserverIndices();
+
+	// Picks nearby players inside each due observer's vision cone
+	void GatherSightRequests(double Now);
+
+	// Reports newly visible targets and drops lost ones from completed traces
+	void ApplySightResults();
+
+	TArray<FPerceptionObserver> Observers;
+
+	TMap<TObjectKey<AEnemy>, int32> ObserverIndices;
+
+	/* =====================================================
+	 * Async Trace Batch
+	 * ===================================================== */
+
+	using FSightPairKey = TPair<TObjectKey<AActor>, TObjectKey<AActor>>;
+
+	struct FSightTrace
+	{
+		TWeakObjectPtr<AActor> Observer;
+		TWeakObjectPtr<AActor> Target;
+		FTraceHandle Handle;
+	};
+
+	struct FSightResult
+	{
+		TWeakObjectPtr<AActor> Observer;
+		TWeakObjectPtr<AActor> Target;
+		bool bVisible = false;
+	};
+
+	struct FCachedSight
+	{
+		bool bVisible = false;
+		double ResultTime = 0.0;
+	};
+
+	// Sends this frame's queued requests to the async trace interface
+	void IssueSightTraces();
+
+	// Collects traces finished since last frame into the cache and CompletedResults
+	void CollectSightTraces(double Now);
+
+	// Drops cache entries nobody has refreshed in a while
+	void PruneSightCache(double Now);
+
+	// Requests queued this frame, keyed so repeats collapse into one trace
+	TMap<FSightPairKey, FSightTrace> QueuedTraces;
+
+	// Traces handed to the engine, waiting for results
+	TArray<FSightTrace> InFlightTraces;
+
+	// Results read back this frame, reused between frames
+	TArray<FSightResult> CompletedResults;
+
+	TMap<FSightPairKey, FCachedSight> SightCache;
+
+	double LastPruneTime = 0.0;
+};
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+
+#include "EnemyPoolSubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+
+/**
+ * Recycles AEnemy actors instead of destroying and respawning them.
+ * Released enemies are hidden, unregistered from every AI service and kept
+ * with their controller and weapon; acquiring one resets it to a fresh
+ * patrolling enemy. Pools are warmed up at level start from UPoolSettings.
+ */
+UCLASS()
+class OPENWORLDRPG_API UEnemyPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Acquire / Release
+	 * ===================================================== */
+
+	 // Returns a live enemy at SpawnTransform, reused when one is pooled.
+	 // Prepare runs before the enemy starts its AI, e.g. to hand over patrol targets
+	AEnemy* AcquireEnemy(
+		TSubclassOf<AEnemy> EnemyClass,
+		const FTransform& SpawnTransform,
+		TFunctionRef<void(AEnemy&)> Prepare);
+
+	AEnemy* AcquireEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& SpawnTransform);
+
+	// Parks the enemy for reuse, or destroys it when its class pool is full
+	void ReleaseEnemy(AEnemy* Enemy);
+
+	// Spawns enemies straight into the pool
+	void WarmUp(TSubclassOf<AEnemy> EnemyClass, int32 Count);
+
+	int32 GetNumPooled(TSubclassOf<AEnemy> EnemyClass) const;
+
+	/* =====================================================
+	 * <UWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	AEnemy* SpawnEnemy(
+		TSubclassOf<AEnemy> EnemyClass,
+		const FTransform& SpawnTransform,
+		TFunctionRef<void(AEnemy&)> Prepare);
+
+	// Free enemies per exact class, most recently released last
+	TMap<TObjectKey<UClass>, TArray<TWeakObjectPtr<AEnemy>>> FreeEnemies;
+};
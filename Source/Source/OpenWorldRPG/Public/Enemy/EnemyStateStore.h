@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+
+/**
+ * Where an enemy's combat target sits relative to its attack and combat radii.
+ */
+enum class EEnemyRangeClass : uint8
+{
+	NoTarget,
+	InsideAttack,
+	InsideCombat,
+	OutsideCombat
+};
+
+/**
+ * Structure-of-arrays mirror of the per-frame enemy data that drives range
+ * decisions: positions, target positions and squared radii.
+ * Slots are stable; removed slots are recycled and flagged inactive so the
+ * arrays stay contiguous for the SIMD range kernel. Only slots flagged as in
+ * combat are synced, everything else keeps a cleared target.
+ */
+class OPENWORLDRPG_API FEnemyStateStore
+{
+public:
+
+	/* =====================================================
+	 * Slots
+	 * ===================================================== */
+
+	int32 AddEnemy(AEnemy* Enemy);
+	void RemoveEnemy(int32 Slot);
+
+	FORCEINLINE int32 Num() const { return Enemies.Num(); }
+	FORCEINLINE AEnemy* GetEnemy(int32 Slot) const { return Enemies[Slot].Get(); }
+	FORCEINLINE EEnemyRangeClass GetRangeClass(int32 Slot) const { return static_cast<EEnemyRangeClass>(RangeClass[Slot]); }
+
+	/* =====================================================
+	 * Mirroring
+	 * ===================================================== */
+
+	 // Copies an enemy's current location, target and radii into its slot
+	void SyncSlot(int32 Slot, const FVector& Location, const AActor* Target, double AttackRadius, double CombatRadius);
+
+	// Marks a slot as having nothing to classify this frame
+	void ClearTarget(int32 Slot);
+
+	// Adds or removes a slot from the combat list; leaving combat clears its target
+	void SetInCombat(int32 Slot, bool bInCombat);
+
+	// Slots that need syncing each frame, in no particular order
+	FORCEINLINE const TArray<int32>& GetCombatSlots() const { return CombatSlots; }
+
+	/* =====================================================
+	 * Classification
+	 * ===================================================== */
+
+	 // Runs the range kernel over every slot and records which slots changed class
+	void Classify();
+
+	// Slots whose range class differs from the previous Classify, valid until the next one
+	FORCEINLINE const TArray<int32>& GetRangeChanges() const { return RangeChanges; }
+
+	/* =====================================================
+	 * Range Kernel
+	 * ===================================================== */
+
+	struct FRangeKernelArgs
+	{
+		const float* PosX = nullptr;
+		const float* PosY = nullptr;
+		const float* PosZ = nullptr;
+		const float* TargetX = nullptr;
+		const float* TargetY = nullptr;
+		const float* TargetZ = nullptr;
+		const float* AttackRadiusSq = nullptr;
+		const float* CombatRadiusSq = nullptr;
+		const uint8* HasTarget = nullptr;
+		uint8* OutRangeClass = nullptr;
+		int32 Num = 0;
+	};
+
+	// Four enemies per iteration with vector registers, scalar tail
+	static void ClassifyRangesSIMD(const FRangeKernelArgs& Args);
+
+	// Reference implementation, kept for the benchmark and for validation
+	static void ClassifyRangesScalar(const FRangeKernelArgs& Args);
+
+private:
+
+	FRangeKernelArgs MakeKernelArgs();
+
+	TArray<TWeakObjectPtr<AEnemy>> Enemies;
+
+	TArray<float> PosX;
+	TArray<float> PosY;
+	TArray<float> PosZ;
+	TArray<float> TargetX;
+	TArray<float> TargetY;
+	TArray<float> TargetZ;
+	TArray<float> AttackRadiusSq;
+	TArray<float> CombatRadiusSq;
+	TArray<uint8> HasTarget;
+
+	// Index into CombatSlots per slot, INDEX_NONE while out of combat
+	TArray<int32> CombatIndex;
+	TArray<int32> CombatSlots;
+
+	TArray<uint8> RangeClass;
+	TArray<uint8> PreviousRangeClass;
+
+	TArray<int32> FreeSlots;
+	TArray<int32> RangeChanges;
+};
@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+
+/**
+ * The AI delays an enemy can have pending, one of each at a time.
+ */
+enum class EEnemyTimer : uint8
+{
+	Patrol,
+	Attack,
+	Death
+};
+
+/**
+ * Refers to one armed timer. Stays safe to cancel after the timer fired
+ * or was cancelled, the generation no longer matches.
+ */
+struct FEnemyTimerHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+
+	FORCEINLINE bool IsSet() const { return Index != INDEX_NONE; }
+	FORCEINLINE void Invalidate() { Index = INDEX_NONE; }
+};
+
+/**
+ * Two-level hierarchical timing wheel for enemy AI delays.
+ * Timers live in a slab and are linked into their slot's intrusive list,
+ * so arming and cancelling are O(1) with no allocation once the slab has
+ * grown. The first level covers the next 256 ticks; further timers wait in
+ * the second level and are cascaded down when the first level wraps.
+ */
+class OPENWORLDRPG_API FEnemyTimingWheel
+{
+public:
+
+	static constexpr int32 SlotsPerLevel = 256;
+	static constexpr int32 NumLevels = 2;
+
+	// 32 ticks a second, finer than any AI delay needs
+	static constexpr double TickSeconds = 1.0 / 32.0;
+
+	struct FFiredTimer
+	{
+		TWeakObjectPtr<AEnemy> Enemy;
+		EEnemyTimer Kind = EEnemyTimer::Patrol;
+
+		// Passed to ConsumeFired right before the callback
+		FEnemyTimerHandle Handle;
+	};
+
+	// Arm, cancel and fire counts, reset by ResetChurn
+	struct FChurn
+	{
+		int32 Armed = 0;
+		int32 Cancelled = 0;
+		int32 Fired = 0;
+	};
+
+	FEnemyTimingWheel();
+
+	/* =====================================================
+	 * Timers
+	 * ===================================================== */
+
+	FEnemyTimerHandle Arm(AEnemy* Enemy, EEnemyTimer Kind, float DelaySeconds);
+
+	// Cancels the timer if it is still pending and invalidates the handle
+	void Cancel(FEnemyTimerHandle& Handle);
+
+	bool IsPending(const FEnemyTimerHandle& Handle) const;
+
+	// Seconds until the timer fires, zero if it isn't pending
+	float GetRemaining(const FEnemyTimerHandle& Handle) const;
+
+	// Moves time forward and appends every timer that came due, in firing order.
+	// Fired timers stay cancellable until consumed
+	void Advance(float DeltaSeconds, TArray<FFiredTimer>& OutFired);
+
+	// Releases a fired timer; false if it was cancelled since Advance, so its callback must not run
+	bool ConsumeFired(const FEnemyTimerHandle& Handle);
+
+	FORCEINLINE int32 GetNumPending() const { return NumPending; }
+
+	/* =====================================================
+	 * Churn
+	 * ===================================================== */
+
+	FORCEINLINE const FChurn& GetChurn() const { return Churn; }
+	FORCEINLINE void ResetChurn() { Churn = FChurn(); }
+
+private:
+
+	struct FTimerNode
+	{
+		TWeakObjectPtr<AEnemy> Enemy;
+		uint64 ExpireTick = 0;
+
+		// Intrusive list links; Next doubles as the free list link
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+
+		// Flat slot index across levels, INDEX_NONE while free, FiredSlot until consumed
+		int32 Slot = INDEX_NONE;
+
+		uint32 Generation = 0;
+		EEnemyTimer Kind = EEnemyTimer::Patrol;
+	};
+
+	int32 AllocateNode();
+	void FreeNode(int32 Index);
+
+	// Links a node into the slot its expiry tick falls in
+	void Link(int32 Index);
+	void Unlink(int32 Index);
+
+	// Moves every timer in the next second-level slot down into the first level
+	void Cascade();
+
+	const FTimerNode* FindPending(const FEnemyTimerHandle& Handle) const;
+
+	// Fired but not yet consumed, matching the handle's generation
+	bool IsFired(const FEnemyTimerHandle& Handle) const;
+
+	static constexpr int32 FiredSlot = -2;
+
+	TArray<FTimerNode> Nodes;
+	TArray<int32> SlotHeads;
+	int32 FreeHead = INDEX_NONE;
+	int32 NumPending = 0;
+
+	uint64 CurrentTick = 0;
+
+	// Time not yet worth a whole tick
+	double Accumulator = 0.0;
+
+	FChurn Churn;
+};
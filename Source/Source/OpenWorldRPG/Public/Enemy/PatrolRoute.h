@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+
+#include "PatrolRoute.generated.h"
+
+/**
+ * How an enemy on a patrol route picks its next waypoint.
+ */
+UENUM(BlueprintType)
+enum class EPatrolTraversal : uint8
+{
+	EPT_WeightedRandom UMETA(DisplayName = "Weighted Random"),
+	EPT_Sequential UMETA(DisplayName = "Sequential")
+};
+
+/**
+ * Waypoints shared by every enemy that patrols them.
+ * The route is flattened once when the level starts; enemies only keep an
+ * index into it, and picking the next waypoint allocates nothing
+ * (O(log n) weighted random, O(1) sequential).
+ */
+UCLASS()
+class OPENWORLDRPG_API APatrolRoute : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Constructor
+	 * ===================================================== */
+
+	APatrolRoute();
+
+	/* =====================================================
+	 * Traversal
+	 * ===================================================== */
+
+	 // Index of the waypoint to walk to after CurrentIndex, INDEX_NONE on an empty route
+	int32 ChooseNextWaypoint(int32 CurrentIndex) const;
+
+	FORCEINLINE int32 GetNumWaypoints() const { return RouteWaypoints.Num(); }
+	FORCEINLINE AActor* GetWaypoint(int32 Index) const { return RouteWaypoints.IsValidIndex(Index) ? RouteWaypoints[Index] : nullptr; }
+
+	// Picks by weight among every waypoint except ExcludedIndex. Random01 is in [0, 1)
+	static int32 SelectWeightedExcluding(TArrayView<const float> CumulativeWeights, int32 ExcludedIndex, float Random01);
+
+	// Picks uniformly among every index in [0, Num) except ExcludedIndex. Random01 is in [0, 1)
+	static int32 SelectUniformExcluding(int32 Num, int32 ExcludedIndex, float Random01);
+
+protected:
+
+	/* =====================================================
+	 * <Actor> Overrides
+	 * ===================================================== */
+
+	 // Runs before any BeginPlay, so enemies always see a built route
+	virtual void PostInitializeComponents() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+
+	// Drops empty waypoints and precomputes cumulative weights
+	void BuildRoute();
+
+	UPROPERTY(EditInstanceOnly, Category = "Patrol Route")
+	TArray<AActor*> Waypoints;
+
+	// Relative chance of each waypoint being picked next, missing entries count as 1
+	UPROPERTY(EditInstanceOnly, Category = "Patrol Route", meta = (ClampMin = "0"))
+	TArray<float> Weights;
+
+	UPROPERTY(EditAnywhere, Category = "Patrol Route")
+	EPatrolTraversal Traversal = EPatrolTraversal::EPT_WeightedRandom;
+
+	// Built from Waypoints and Weights
+	UPROPERTY(Transient)
+	TArray<AActor*> RouteWaypoints;
+
+	TArray<float> CumulativeWeights;
+};
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UProgressBar;
+class UTextBlock;
+
+/**
+ * Values the overlay shows, collected during the frame and pushed to the
+ * widgets at most once per frame. Setters only record a value that really
+ * changed, so an idle player causes no widget updates, and text is only
+ * formatted for values that changed.
+ */
+struct OPENWORLDRPG_API FSlashHUDModel
+{
+public:
+	void SetHealthPercent(float Percent);
+	void SetStaminaPercent(float Percent);
+	void SetGold(int32 Gold);
+	void SetSouls(int32 Souls);
+
+	FORCEINLINE bool IsDirty() const { return DirtyFields != 0; }
+
+	//pushes only the changed values, any widget may be null
+	void Flush(UProgressBar* HealthBar, UProgressBar* StaminaBar, UTextBlock* GoldText, UTextBlock* SoulsText);
+
+	//widgets updated by the last flush
+	FORCEINLINE int32 GetLastNumUpdates() const { return LastNumUpdates; }
+
+private:
+	enum EField : uint8
+	{
+		Health = 1 << 0,
+		Stamina = 1 << 1,
+		Gold = 1 << 2,
+		Souls = 1 << 3
+	};
+
+	//bars move by pixels, smaller changes aren't worth an invalidation
+	static constexpr float PercentTolerance = 0.001f;
+
+	//negative until the first value arrives, so the first set always counts as a change
+	float HealthPercent = -1.f;
+	float StaminaPercent = -1.f;
+	int32 GoldAmount = -1;
+	int32 SoulsAmount = -1;
+
+	uint8 DirtyFields = 0;
+
+	int32 LastNumUpdates = 0;
+};
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
+#include "HUD/SlashHUDModel.h"
 #include "SlashOverlay.generated.h"
 
 /**
@@ -19,7 +20,13 @@ public:
 	void SetStaminaBarPercent(float Percent);
 	void SetGold(int32 Gold);
 	void SetSouls(int32 Souls);
+
+	FORCEINLINE const FSlashHUDModel& GetHUDModel() const { return HUDModel; }
+protected:
+	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
 private:
+	FSlashHUDModel HUDModel;
+
 	//variable names need to be same of those in blueprints
 	UPROPERTY(meta = (BindWidget))
 	class UProgressBar* HealthProgressBar;
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "PoolableInterface.generated.h"
+
+// This class does not need to be modified.
+UINTERFACE(MinimalAPI)
+class UPoolableInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Actors recycled by UActorPoolSubsystem.
+ * The pool hides the actor and turns off its collision and tick itself;
+ * these hooks reset or tear down whatever else the actor owns.
+ */
+class OPENWORLDRPG_API IPoolableInterface
+{
+	GENERATED_BODY()
+
+public:
+	// Called after the actor was moved into place and shown again
+	virtual void OnAcquiredFromPool();
+
+	// Called before the actor is hidden and parked
+	virtual void OnReleasedToPool();
+};
@@ -4,50 +4,60 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Interfaces/PoolableInterface.h"
 #include "Item.generated.h"
 
 class USphereComponent;
 class UNiagaraComponent;
 class UNiagaraSystem;
+class IPickupInterface;
 
 
 enum class EItemState : uint8
 {
 	EIS_Hovering,
-	EIS_Equipped
+	EIS_Equipped,
+	//claimed by ULootAggregationSubsystem, being pulled in or about to be collected
+	EIS_Collecting
 
 };
 UCLASS()
-class OPENWORLDRPG_API AItem : public AActor
+class OPENWORLDRPG_API AItem : public AActor, public IPoolableInterface
 {
 	GENERATED_BODY()
 	
 public:	
 	// Sets default values for this actor's properties
 	AItem();
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
 
-protected:
-	// Called when the game starts or when spawned
-	virtual void BeginPlay() override;
+	//pooling, items are recycled through UActorPoolSubsystem
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReleasedToPool() override;
 
-	//overlap collisions
-	UFUNCTION()
-	virtual void OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	//pickup proximity, driven by UPickupProximitySubsystem instead of sphere overlaps
+	virtual void OnPickupRangeEntered(IPickupInterface* Picker);
+	virtual void OnPickupRangeExited(IPickupInterface* Picker);
+	float GetPickupRadius() const;
+
+	FORCEINLINE EItemState GetItemState() const { return ItemState; }
+
+	//hovering items bob through UItemAnimationSubsystem, any other state stays put
+	void SetItemState(EItemState NewState);
 
-	//end overlap
-	UFUNCTION()
-	virtual void OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
-	
 	virtual void SpawnPickupSystem();
 	virtual void SpawnPickupSound();
 
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	UStaticMeshComponent* ItemMesh;
 
 	EItemState ItemState = EItemState::EIS_Hovering; 
 
+	//only its radius is used, as the pickup range
 	UPROPERTY(VisibleAnywhere)
 	USphereComponent* Sphere;
 
@@ -56,9 +66,9 @@ protected:
 
 	UPROPERTY(EditAnywhere)
 	USoundBase* PickupSound;
-	//high it floats
+	//how far it floats above and below where it was placed
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Floating")
-	float Amplitude = 1.f;
+	float Amplitude = 15.f;
 	//speed it bobs
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Floating")
 	float TimeConstant = 2.f;
@@ -67,9 +77,12 @@ private:
 	
 	//floating movement
 
-	float RunningTime;
+	void StartHovering();
+	void StopHovering();
 
-	float TransformedSin() const;
+	//where the bob is centred, captured once when hovering starts
+	FVector HoverRestLocation = FVector::ZeroVector;
+	bool bHovering = false;
 
 	UPROPERTY(EditAnywhere)
 	UNiagaraSystem* PickupEffect;
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "ItemAnimationSubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AItem;
+
+/**
+ * Drives the hover bob of every EIS_Hovering item in one batched tick,
+ * so items themselves don't tick. Bob offsets are evaluated for all items
+ * in one pass over flat arrays; only items that were recently rendered or
+ * are near a player are actually moved.
+ */
+UCLASS()
+class OPENWORLDRPG_API UItemAnimationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Registration
+	 * ===================================================== */
+
+	 // Starts bobbing around RestLocation, which the caller captured before any bob was applied
+	void AddItem(AItem* Item, const FVector& RestLocation, float Amplitude, float TimeConstant);
+	void RemoveItem(AItem* Item);
+
+	// Height above the base location after RunningTime seconds, period = 2*pi/TimeConstant
+	static FORCEINLINE float TransformedSin(float Amplitude, float TimeConstant, float RunningTime)
+	{
+		return Amplitude * FMath::Sin(RunningTime * TimeConstant);
+	}
+
+	FORCEINLINE int32 GetNumItems() const { return Items.Num(); }
+
+	// Items actually moved last frame
+	FORCEINLINE int32 GetLastNumMoved() const { return LastNumMoved; }
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void RemoveAt(int32 Index);
+
+	bool IsRelevant(const AItem* Item, const FVector& BaseLocation, double RelevanceRadiusSquared, float RenderedTolerance) const;
+
+	void RefreshPlayerLocations();
+
+	/* =====================================================
+	 * Items
+	 * ===================================================== */
+
+	// One element per item, kept parallel
+	TArray<TWeakObjectPtr<AItem>> Items;
+	TArray<FVector> BaseLocations;
+	TArray<float> RunningTimes;
+	TArray<float> Amplitudes;
+	TArray<float> TimeConstants;
+	TArray<float> Offsets;
+
+	// Weak keys still match after the item is gone, so stale entries can be dropped
+	TMap<TWeakObjectPtr<AItem>, int32> ItemToIndex;
+
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+
+	int32 LastNumMoved = 0;
+};
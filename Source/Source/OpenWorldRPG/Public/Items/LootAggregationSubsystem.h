@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "LootAggregationSubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AItem;
+class ASoul;
+class ATreasure;
+class APawn;
+class IPickupInterface;
+
+/**
+ * Keeps loot bounded during mass kills.
+ *
+ * Drops: a soul or treasure dropped near a hovering pickup of the same
+ * class is folded into it, so a cluster of kills leaves one pickup
+ * carrying the summed value instead of one actor per enemy.
+ *
+ * Collection: collected pickups are queued and flushed once per frame,
+ * one AddSouls/AddGold call and one pickup effect per player. Pickups
+ * within rpg.Loot.VacuumRadius of a player are pulled in and collected
+ * on arrival.
+ */
+UCLASS()
+class OPENWORLDRPG_API ULootAggregationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Drops
+	 * ===================================================== */
+
+	 // Returns the soul now carrying the amount, either a nearby merged one or a new one
+	ASoul* DropSouls(TSubclassOf<ASoul> SoulClass, const FTransform& Transform, int32 Souls);
+	ATreasure* DropTreasure(TSubclassOf<ATreasure> TreasureClass, const FTransform& Transform);
+
+	/* =====================================================
+	 * Collection
+	 * ===================================================== */
+
+	 // The pickup is claimed now and handed to Picker with this frame's batch
+	void QueueCollection(IPickupInterface* Picker, AItem* Pickup);
+
+	// Pickups folded into another at drop time, and batches flushed, since the world started
+	FORCEINLINE int32 GetNumMerged() const { return NumMerged; }
+	FORCEINLINE int32 GetNumBatchesFlushed() const { return NumBatchesFlushed; }
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	// Nearest hovering pickup of exactly this class within the merge radius
+	AItem* FindMergeTarget(UClass* PickupClass, const FVector& Location) const;
+
+	/* =====================================================
+	 * Vacuum
+	 * ===================================================== */
+
+	struct FVacuumedPickup
+	{
+		TWeakObjectPtr<AItem> Pickup;
+		TWeakObjectPtr<APawn> Player;
+	};
+
+	void StartVacuum(float VacuumRadius);
+	void UpdateVacuum(float DeltaTime);
+
+	TArray<FVacuumedPickup> Vacuumed;
+
+	/* =====================================================
+	 * Batches
+	 * ===================================================== */
+
+	struct FCollectionBatch
+	{
+		TWeakObjectPtr<UObject> Picker;
+		TArray<TWeakObjectPtr<ASoul>, TInlineAllocator<8>> Souls;
+		TArray<TWeakObjectPtr<ATreasure>, TInlineAllocator<8>> Treasures;
+	};
+
+	void FlushBatches();
+	static void FlushBatch(FCollectionBatch& Batch);
+
+	TArray<FCollectionBatch> Batches;
+
+	// Reused by the vacuum query
+	TArray<AActor*> NearbyActors;
+
+	int32 NumMerged = 0;
+	int32 NumBatchesFlushed = 0;
+};
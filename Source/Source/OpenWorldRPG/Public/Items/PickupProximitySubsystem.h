@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "PickupProximitySubsystem.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AItem;
+class APawn;
+
+/**
+ * Detects pickups without physics overlaps. At a fixed rate every player
+ * pawn implementing IPickupInterface queries the spatial hash for nearby
+ * items, and items whose pickup radius it has entered or left get
+ * OnPickupRangeEntered / OnPickupRangeExited, which fire the interface
+ * callbacks the sphere overlaps used to.
+ */
+UCLASS()
+class OPENWORLDRPG_API UPickupProximitySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	/* =====================================================
+	 * Proximity
+	 * ===================================================== */
+
+	struct FPickupWatcher
+	{
+		// Items this player was inside the pickup radius of at the last query
+		TArray<TWeakObjectPtr<AItem>, TInlineAllocator<8>> InRange;
+	};
+
+	void UpdateWatcher(APawn* Player, FPickupWatcher& Watcher);
+
+	// Sphere against the player's capsule, or its location for pawns without one
+	static bool IsInPickupRange(const APawn* Player, const AItem* Item);
+
+	TMap<TWeakObjectPtr<APawn>, FPickupWatcher> Watchers;
+
+	// Reused by every query
+	TArray<AActor*> NearbyActors;
+	TArray<TWeakObjectPtr<AItem>, TInlineAllocator<8>> NowInRange;
+
+	float TimeSinceQuery = 0.f;
+};
@@ -13,8 +13,9 @@ UCLASS()
 class OPENWORLDRPG_API ASoul : public AItem
 {
 	GENERATED_BODY()
-protected:
-	virtual void OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex) override;
+public:
+	//souls are collected as the player walks back out of them
+	virtual void OnPickupRangeExited(IPickupInterface* Picker) override;
 
 private:
 	UPROPERTY(EditAnywhere, Category = "Soul Properties")
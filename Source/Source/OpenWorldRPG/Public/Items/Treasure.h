@@ -14,9 +14,12 @@ class OPENWORLDRPG_API ATreasure : public AItem
 {
 	GENERATED_BODY()
 
-protected:
+public:
+
+	virtual void OnPickupRangeEntered(IPickupInterface* Picker) override;
 
-	virtual void OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) override;
+	//merged treasure carries more gold, so a recycled one starts from the class value again
+	virtual void OnAcquiredFromPool() override;
 	
 private:
 	//sound 
@@ -24,4 +27,5 @@ private:
 	int32 Gold;
 public:
 	FORCEINLINE int32 GetGold() const { return Gold; }
+	FORCEINLINE void SetGold(int32 AmountOfGold) { Gold = AmountOfGold; }
 };
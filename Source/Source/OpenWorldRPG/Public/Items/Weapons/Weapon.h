@@ -7,6 +7,7 @@
 ==============================*/
 #include "CoreMinimal.h"
 #include "Items/Item.h"
+#include "Items/Weapons/WeaponHitRegistry.h"
 #include "Weapon.generated.h"
 
 /*==============================
@@ -30,6 +31,11 @@ public:
 	==============================*/
 	AWeapon();
 
+	virtual void Tick(float DeltaTime) override;
+
+	// Pooled weapons drop their owner and attachment when released
+	virtual void OnReleasedToPool() override;
+
 	/*==============================
 		Weapon Interface
 	==============================*/
@@ -63,8 +69,12 @@ public:
 
 	FORCEINLINE UBoxComponent* GetWeaponBox() const { return WeaponBox; }
 
-	// Actors already hit during current swing
-	TArray<AActor*> IgnoreActors;
+	// Attack window, opened and closed by the owner's attack notifies through
+	// SetWeaponCollisionEnabled. While open the blade is swept every frame
+	void BeginSwing();
+	void EndSwing();
+
+	FORCEINLINE bool IsSwinging() const { return bSwinging; }
 
 protected:
 	/*==============================
@@ -77,23 +87,9 @@ protected:
 		Collision Handling
 	==============================*/
 
-	// Called when weapon box overlaps another actor
-	UFUNCTION()
-	void OnBoxOverlap(
-		UPrimitiveComponent* OverlappedComponent,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex,
-		bool bFromSweep,
-		const FHitResult& SweepResult
-	);
-
 	// Prevent friendly-fire between same actor types
 	bool ActorIsSameType(AActor* OtherActor);
 
-	// Calls GetHit on hit actor via interface
-	void ExecuteGetHit(FHitResult& BoxHit);
-
 	// Blueprint hook for spawning hit fields (Niagara, decals, etc.)
 	UFUNCTION(BlueprintImplementableEvent)
 	void CreateFields(const FVector& FieldLocation);
@@ -103,8 +99,58 @@ private:
 		Tracing
 	==============================*/
 
-	// Performs box trace for hit detection
-	void BoxTrace(FHitResult& BoxHit);
+	// Where the blade's trace box runs from and to at one moment of the swing
+	struct FBladePose
+	{
+		FVector Start = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+		FQuat Rotation = FQuat::Identity;
+	};
+
+	FBladePose GetBladePose() const;
+
+	// Sweeps the blade through the poses between last frame and this one,
+	// then hands every new hit to UCombatResolutionSubsystem together
+	void SampleSwing();
+
+	// Sweeps the trace box along the blade, skipping actors already hit this swing
+	bool BoxTrace(const FBladePose& Pose, FHitResult& BoxHit) const;
+
+	// Cleave version, every pawn or destructible the blade passes through, nearest first
+	void BoxTraceMulti(const FBladePose& Pose, TArray<FHitResult>& OutHits) const;
+
+	// Traces one sub-step and queues whatever it newly hit
+	void CollectHits(const FBladePose& Pose);
+	void QueueHit(const FHitResult& BoxHit);
+
+	void ApplySwingHits();
+
+	FORCEINLINE bool IsOutOfCleaveTargets() const { return bCleave && HitRegistry.Num() >= MaxCleaveTargets; }
+
+	// Moves the weapon's tick prerequisite to the component it is attached to, nullptr drops it
+	void SetTickParent(USceneComponent* NewParent);
+
+	// Component the weapon currently ticks after, so re-attaching never stacks prerequisites
+	TWeakObjectPtr<USceneComponent> TickParent;
+
+	bool bSwinging = false;
+
+	// Actors already hit during current swing, plus the query params that ignore them
+	FWeaponHitRegistry HitRegistry;
+
+	FBladePose LastBladePose;
+
+	struct FPendingHit
+	{
+		FHitResult BoxHit;
+		float Damage = 0.f;
+	};
+
+	// New hits from this frame's sub-steps, applied once sampling is done
+	TArray<FPendingHit, TInlineAllocator<4>> PendingHits;
+
+	// Reused by every cleave sweep
+	TArray<FHitResult> CleaveHits;
 
 	/*==============================
 		Weapon Properties
@@ -116,12 +162,30 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	bool bShowBoxDebug = false;
 
+	// Furthest the blade tip moves between two traces, fast swings get more sub-steps
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties", meta = (ClampMin = "1"))
+	float SwingSubstepLength = 25.f;
+
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties", meta = (ClampMin = "1"))
+	int32 MaxSwingSubsteps = 8;
+
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	USoundBase* EquipSound;
 
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	float Damage = 20.f;
 
+	// Cleaving swings hit everything the blade passes through, not just the first actor
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties|Cleave")
+	bool bCleave = false;
+
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties|Cleave", meta = (EditCondition = "bCleave", ClampMin = "1"))
+	int32 MaxCleaveTargets = 3;
+
+	// Each further target in a swing takes this fraction less damage than the one before
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties|Cleave", meta = (EditCondition = "bCleave", ClampMin = "0", ClampMax = "1"))
+	float CleaveFalloff = 0.25f;
+
 	/*==============================
 		Components
 	==============================*/
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/*==============================
+	Core Includes
+==============================*/
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * Actors a weapon already hit during the current swing.
+ * Keeps the query params for the swing's sweeps alongside, so every hit is
+ * ignored by later sweeps without rebuilding an ignore list per trace.
+ */
+struct OPENWORLDRPG_API FWeaponHitRegistry
+{
+public:
+	/*==============================
+		Swing
+	==============================*/
+
+	// Starts a new swing that ignores only the weapon and its owner
+	void Reset(const AActor* Weapon, const AActor* Owner);
+
+	// Records Actor as hit; false if it was already hit this swing
+	bool Register(const AActor* Actor);
+
+	bool Contains(const AActor* Actor) const;
+
+	FORCEINLINE int32 Num() const { return HitActors.Num(); }
+	FORCEINLINE const FCollisionQueryParams& GetQueryParams() const { return QueryParams; }
+
+private:
+	// Swings rarely hit more than a handful of actors
+	TArray<TObjectKey<AActor>, TInlineAllocator<8>> HitActors;
+
+	FCollisionQueryParams QueryParams;
+};
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+
+#include "ActorPoolSubsystem.generated.h"
+
+/**
+ * Typed pool for short-lived actors such as souls, treasure and weapons.
+ * Released actors are hidden with collision and tick off and handed back
+ * by AcquireActor instead of spawning a new one. Actors implementing
+ * IPoolableInterface get hooks to reset their own state.
+ * Per-class warm-up counts come from UPoolSettings.
+ */
+UCLASS()
+class OPENWORLDRPG_API UActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Acquire / Release
+	 * ===================================================== */
+
+	 // Returns a pooled actor of exactly ActorClass moved to Transform, or spawns one
+	AActor* AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform);
+
+	template<typename T>
+	T* Acquire(TSubclassOf<T> ActorClass, const FTransform& Transform)
+	{
+		return Cast<T>(AcquireActor(ActorClass, Transform));
+	}
+
+	// Parks the actor for reuse, or destroys it when its class pool is full
+	void ReleaseActor(AActor* Actor);
+
+	// Releases through the actor's world pool, or destroys the actor when there is none
+	static void ReleaseOrDestroy(AActor* Actor);
+
+	// Spawns actors straight into the pool
+	void WarmUp(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	/* =====================================================
+	 * Stats
+	 * ===================================================== */
+
+	struct FPoolStats
+	{
+		int32 Hits = 0;
+		int32 Misses = 0;
+		int32 Releases = 0;
+
+		// Releases destroyed because the pool was full
+		int32 Discards = 0;
+
+		// Actors parked in the pool, updated on every acquire, release and warm-up
+		int32 NumFree = 0;
+	};
+
+	const FPoolStats* GetStats(TSubclassOf<AActor> ActorClass) const;
+
+	// Logs hit/miss rates for every pooled class
+	void DumpStats() const;
+
+	/* =====================================================
+	 * <UWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	struct FActorPool
+	{
+		TWeakObjectPtr<UClass> ActorClass;
+
+		// Most recently released last
+		TArray<TWeakObjectPtr<AActor>> FreeActors;
+
+		FPoolStats Stats;
+	};
+
+	void DeactivateActor(AActor* Actor);
+	void ActivateActor(AActor* Actor, const FTransform& Transform);
+
+	TMap<TObjectKey<UClass>, FActorPool> Pools;
+};
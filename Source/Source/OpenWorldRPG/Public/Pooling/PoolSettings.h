@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+
+#include "PoolSettings.generated.h"
+
+// =======================
+// Forward Declarations
+// =======================
+class AEnemy;
+
+/**
+ * Project Settings > Game > Actor Pools.
+ * How many actors of each class are spawned up front when a level starts,
+ * and how many released actors are kept around for reuse.
+ */
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "Actor Pools"))
+class OPENWORLDRPG_API UPoolSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Enemies
+	 * ===================================================== */
+
+	 // Enemies spawned and parked in the pool when a level starts
+	UPROPERTY(Config, EditAnywhere, Category = "Enemies", meta = (ClampMin = "0"))
+	TMap<TSoftClassPtr<AEnemy>, int32> EnemyWarmUpCounts;
+
+	// Released enemies beyond this many per class are destroyed instead of pooled
+	UPROPERTY(Config, EditAnywhere, Category = "Enemies", meta = (ClampMin = "0"))
+	int32 MaxPooledEnemiesPerClass = 64;
+
+	/* =====================================================
+	 * Actors
+	 * ===================================================== */
+
+	 // Souls, treasure, weapons and other UActorPoolSubsystem actors spawned up front
+	UPROPERTY(Config, EditAnywhere, Category = "Actors", meta = (ClampMin = "0"))
+	TMap<TSoftClassPtr<AActor>, int32> ActorWarmUpCounts;
+
+	// Released actors beyond this many per class are destroyed instead of pooled
+	UPROPERTY(Config, EditAnywhere, Category = "Actors", meta = (ClampMin = "0"))
+	int32 MaxPooledActorsPerClass = 128;
+};
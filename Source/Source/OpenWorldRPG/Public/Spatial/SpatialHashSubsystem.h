@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// =======================
+// Core
+// =======================
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+
+#include "SpatialHashSubsystem.generated.h"
+
+/**
+ * What kind of actor a spatial hash entry is, so queries can filter cheaply.
+ */
+enum class ESpatialCategory : uint8
+{
+	None = 0,
+	Player = 1 << 0,
+	Enemy = 1 << 1,
+	Item = 1 << 2,
+	Breakable = 1 << 3,
+	All = 0xFF
+};
+ENUM_CLASS_FLAGS(ESpatialCategory);
+
+/**
+ * Uniform 2D spatial hash over the XY plane.
+ * Characters, items and breakables register here so proximity queries
+ * cost O(neighbors) instead of O(actors). Distances are compared squared.
+ */
+UCLASS()
+class OPENWORLDRPG_API USpatialHashSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* =====================================================
+	 * Registration
+	 * ===================================================== */
+
+	 // Dynamic actors have their cell refreshed every frame, static ones only on request
+	void RegisterActor(AActor* Actor, ESpatialCategory Category, bool bDynamic);
+	void UnregisterActor(AActor* Actor);
+
+	// Re-buckets a static actor after it was moved
+	void UpdateActorLocation(AActor* Actor);
+
+	/* =====================================================
+	 * Queries
+	 * ===================================================== */
+
+	 // Calls Visitor for every registered actor matching CategoryMask within Radius of Origin
+	void ForEachInRadius(
+		const FVector& Origin,
+		double Radius,
+		ESpatialCategory CategoryMask,
+		TFunctionRef<void(AActor* Actor, double DistSquared)> Visitor) const;
+
+	template<typename AllocatorType>
+	void QueryRadius(
+		const FVector& Origin,
+		double Radius,
+		ESpatialCategory CategoryMask,
+		TArray<AActor*, AllocatorType>& OutActors) const
+	{
+		ForEachInRadius(Origin, Radius, CategoryMask,
+			[&OutActors](AActor* Actor, double) { OutActors.Add(Actor); });
+	}
+
+	/* =====================================================
+	 * <UTickableWorldSubsystem> Overrides
+	 * ===================================================== */
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	/* =====================================================
+	 * Grid Storage
+	 * ===================================================== */
+
+	struct FSpatialEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+
+		// Still valid once the actor is gone, so stale entries can leave ActorToEntry
+		TObjectKey<AActor> ActorKey;
+
+		FVector Location = FVector::ZeroVector;
+		FIntPoint Cell = FIntPoint::ZeroValue;
+		ESpatialCategory Category = ESpatialCategory::None;
+		bool bDynamic = false;
+
+		// Position in DynamicEntries, INDEX_NONE for static entries
+		int32 DynamicIndex = INDEX_NONE;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+	void AddToCell(int32 EntryIndex);
+	void RemoveFromCell(int32 EntryIndex);
+	void MoveEntry(int32 EntryIndex, const FVector& NewLocation);
+	void RemoveEntry(int32 EntryIndex);
+
+	// Stable indices so cells can refer to entries by index
+	TSparseArray<FSpatialEntry> Entries;
+
+	TMap<TObjectKey<AActor>, int32> ActorToEntry;
+
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<8>>> Cells;
+
+	// Indices of dynamic entries, refreshed each tick; entries whose actor is gone are dropped there
+	TArray<int32> DynamicEntries;
+
+	double CellSize = 1000.0;
+};